@@ -0,0 +1,92 @@
+#include <stdio.h>
+#include <time.h>
+#include <stdlib.h>
+#include <string.h>
+#include "game.h"
+#include "lockstep.h"
+
+int parseBatchOptions(int, char **, int *, int *, int *, int *, int *, unsigned int *, char **);
+
+int main(int argc, char *argv[]){
+	int matches, rounds, quiet, events, seedSet;
+	unsigned int seed;
+	char * rosterPath;
+	if(parseBatchOptions(argc, argv, &matches, &rounds, &quiet, &events, &seedSet, &seed, &rosterPath)){
+		printf("usage: batch [--matches n] [--rounds n] [--events] [--seed n] [--quiet] [--roster file]\n");
+		return 1;
+	}
+	int line = rosterPath != NULL ? gameLoadRoster(rosterPath) : 0;
+	if(line){
+		printf("cannot load roster %s (line %d)\n", rosterPath, line);
+		return 1;
+	}
+	if(rounds == 0)
+		rounds = ROUNDS;
+	if(!seedSet)
+		seed = (unsigned int)time(NULL);
+
+	struct batch b;
+	batchInit(&b, matches);
+	b.seed = seed;
+
+	int round, m;
+	long long played = 0;
+	long long before = wall_clock_time();
+	if(events){
+		for(m = 0; m < matches; m++)
+			played += batchFastForward(&b, m, rounds);
+	}
+	else{
+		for(round = 0; round < rounds; round++)
+			batchRound(&b, round);
+	}
+	long long after = wall_clock_time();
+
+	if(!quiet){
+		for(m = 0; m < matches; m++)
+			printf("%d %d %d\n", m, b.score[m*2], b.score[m*2+1]);
+	}
+	double sec = (double)(after-before)/1000000000;
+	printf("%d matches x %d rounds in %1.5f sec, %1.1f matches/sec\n", matches, rounds, sec, matches/sec);
+	if(events)
+		printf("%1.1f rounds played per match, the rest skipped\n", (double)played/matches);
+
+	batchFree(&b);
+	return 0;
+}
+
+//returns nonzero if the command line is not understood
+int parseBatchOptions(int argc, char *argv[], int * matches, int * rounds, int * quiet, int * events, int * seedSet, unsigned int * seed, char ** rosterPath){
+	int i;
+	*matches = 1000;
+	*rounds = 0;		//the roster's
+	*rosterPath = NULL;
+	*quiet = 0;
+	*events = 0;
+	*seedSet = 0;
+	for(i = 1; i < argc; i++){
+		if(strcmp(argv[i], "--matches") == 0 && i+1 < argc){
+			*matches = atoi(argv[++i]);
+			if(*matches <= 0)
+				return 1;
+		}
+		else if(strcmp(argv[i], "--rounds") == 0 && i+1 < argc){
+			*rounds = atoi(argv[++i]);
+			if(*rounds <= 0)
+				return 1;
+		}
+		else if(strcmp(argv[i], "--quiet") == 0)
+			*quiet = 1;
+		else if(strcmp(argv[i], "--events") == 0)
+			*events = 1;
+		else if(strcmp(argv[i], "--seed") == 0 && i+1 < argc){
+			*seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+			*seedSet = 1;
+		}
+		else if(strcmp(argv[i], "--roster") == 0 && i+1 < argc)
+			*rosterPath = argv[++i];
+		else
+			return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,42 @@
+#!/bin/sh
+# whole-match benchmark: one csv line per output mode and layout, from match --timing --profile.
+# usage: ./bench.sh [rounds] [layout ...]      layouts are fp (fp0/fp1, 12 ranks) or tile grids like 2x2
+# set MODES to pick output modes (default "text none binary"), MPIRUN to change the launcher,
+# THREADS to host that many players per rank as threads (--threads), COMM to pick --comm,
+# ROSTER to play a roster file (--roster); the rank counts follow its number of players
+MPIRUN=${MPIRUN:-mpirun}
+MODES=${MODES:-"text none binary"}
+PLAYERS=10
+ROSTERFLAG=""
+if [ -n "$ROSTER" ]; then
+	PLAYERS=$(awk '{ sub(/#.*/, "") } $1 == "a" || $1 == "b" { n++ } END { print n+0 }' "$ROSTER") || exit 1
+	ROSTERFLAG="--roster $ROSTER"
+fi
+THREADS=${THREADS:-1}
+COMM=${COMM:-p2p}
+ROUNDS=${1:-5400}
+[ $# -gt 0 ] && shift
+LAYOUTS=${*:-"fp"}
+OUT=${TMPDIR:-/tmp}/bench.$$
+
+echo "mode,layout,ranks,rounds,rounds_per_sec,p50_round_us,p99_round_us,max_rss_kb,rss_kb_per_rank"
+for layout in $LAYOUTS; do
+	if [ "$layout" = fp ]; then
+		ranks=$((2 + PLAYERS/THREADS))
+		flags=""
+	else
+		ranks=$((${layout%x*} * ${layout#*x} + PLAYERS/THREADS))
+		flags="--tiles $layout"
+	fi
+	[ "$THREADS" -gt 1 ] && flags="$flags --threads $THREADS"
+	[ "$COMM" != p2p ] && flags="$flags --comm $COMM"
+	for mode in $MODES; do
+		$MPIRUN -np $ranks ./match $flags $ROSTERFLAG --rounds $ROUNDS --output $mode --trace $OUT.trace --timing --profile >$OUT.out 2>$OUT.err
+		awk -v mode=$mode -v layout=$layout -v ranks=$ranks -v rounds=$ROUNDS '
+			/usec\/round/ { for(i = 1; i <= NF; i++) if($i == "sec,") sec = $(i-1) }
+			/^peak rss kB:/ { max = 0; per = ""; for(i = 4; i <= NF; i++){ if($i > max) max = $i; per = per (i > 4 ? ":" : "") $i } }
+			/^round / { p50 = $5; p99 = $7 }
+			END { printf "%s,%s,%d,%d,%.1f,%s,%s,%d,%s\n", mode, layout, ranks, rounds, rounds/sec, p50, p99, max, per }' $OUT.err
+	done
+done
+rm -f $OUT.out $OUT.err $OUT.trace
@@ -0,0 +1,220 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "game.h"
+#include "lanes.h"
+
+//microbenchmarks of the per-round game rules, single process. prints csv: function,calls,ns_per_call.
+//first checks the closed form and vector kernels against the rules they replace, and fails on a difference
+#define CASES 4096
+
+struct benchCase{
+	int rank;
+	int round;
+	int ball[2];
+	int pos[2];
+	int speed;
+	int skill;
+	int dist;
+};
+
+static struct benchCase cases[CASES];
+static volatile long long sink;
+
+static void makeCases(unsigned int seed){
+	struct rngStream rng;
+	int i;
+	rngStart(&rng, seed, 0, 0, 0);
+	for(i = 0; i < CASES; i++){
+		struct benchCase * c = &cases[i];
+		c->rank = rngNext(&rng) % PLAYERS + 2;
+		c->round = rngNext(&rng) % ROUNDS;
+		c->ball[X] = rngNext(&rng) % (LENGTH+1);
+		c->ball[Y] = rngNext(&rng) % (WIDTH+1);
+		c->pos[X] = rngNext(&rng) % (LENGTH+1);
+		c->pos[Y] = rngNext(&rng) % (WIDTH+1);
+		c->speed = rngNext(&rng) % 10 + 1;
+		c->skill = rngNext(&rng) % 10 + 1;
+		c->dist = rngNext(&rng) % (LENGTH+WIDTH) + 1;
+	}
+}
+
+//run() as it was, one unit per call
+static void runStepwise(int destX, int destY, int *currX, int *currY, int distance){
+	if(distance == 0)
+		return;
+	else if(*currX == destX){
+		*currY = (*currY > destY) ? *currY - 1 : *currY + 1;
+		runStepwise(destX, destY, currX, currY, distance-1);
+	}
+	else if(*currY == destY){
+		*currX = (*currX > destX) ? *currX - 1 : *currX + 1;
+		runStepwise(destX, destY, currX, currY, distance-1);
+	}
+	else{
+		if(distance == 1){
+			*currX = (*currX > destX) ? *currX - 1 : *currX + 1;
+			return;
+		}
+		*currX = (*currX > destX) ? *currX - 1 : *currX + 1;
+		*currY = (*currY > destY) ? *currY - 1 : *currY + 1;
+		runStepwise(destX, destY, currX, currY, distance-2);
+	}
+}
+
+//returns the number of differences between the kernels and the rules
+static int checkKernels(void){
+	int bad = 0;
+	int x, y, d, s, i, rank;
+	for(x = 0; x <= 40; x++){		//every offset to the destination, including runs past it
+		for(y = 0; y <= 40; y++){
+			for(d = 0; d <= 50; d++){
+				int ax = x, ay = y, bx = x, by = y;
+				run(20, 20, &ax, &ay, d);
+				runStepwise(20, 20, &bx, &by, d);
+				bad += ax != bx || ay != by;
+			}
+		}
+	}
+	for(d = 0; d < 2*(MAX_LENGTH+MAX_WIDTH); d++){
+		for(s = 0; s <= 20; s++){
+			float ratio = (10.0+90.0*s)/(0.5*d*pow(d,0.5)-0.5);
+			float want = ratio < 100 ? ratio/100.0 : 1;
+			bad += getShotProbability(d, s) != want;
+		}
+	}
+	for(rank = 2; rank < PROCESSES; rank++){
+		int ballX[CASES], ballY[CASES], speed[CASES];
+		int posX[2][CASES], posY[2][CASES];
+		for(i = 0; i < CASES; i++){
+			ballX[i] = cases[i].ball[X];
+			ballY[i] = cases[i].ball[Y];
+			speed[i] = cases[i].speed;
+			posX[0][i] = posX[1][i] = cases[i].pos[X];
+			posY[0][i] = posY[1][i] = cases[i].pos[Y];
+		}
+		lanesForceScalar(1);
+		lanesMove(rank, cases[rank].round, CASES, ballX, ballY, posX[0], posY[0], speed);
+		lanesForceScalar(0);
+		lanesMove(rank, cases[rank].round, CASES, ballX, ballY, posX[1], posY[1], speed);
+		for(i = 0; i < CASES; i++)
+			bad += posX[0][i] != posX[1][i] || posY[0][i] != posY[1][i];
+	}
+	return bad;
+}
+
+static void report(const char * name, long long calls, long long ns){
+	printf("%s,%lld,%1.2f\n", name, calls, (double)ns/calls);
+}
+
+static void benchRunStrategy(int passes){
+	int p, i;
+	long long acc = 0;
+	long long before = wall_clock_time();
+	for(p = 0; p < passes; p++){
+		for(i = 0; i < CASES; i++){
+			struct benchCase * c = &cases[i];
+			int end[2] = {c->pos[X], c->pos[Y]};
+			runStrategy(c->rank, c->round, c->ball, c->pos, end, c->speed);
+			acc += end[X] + end[Y];
+		}
+	}
+	report("runStrategy", (long long)passes*CASES, wall_clock_time() - before);
+	sink = acc;
+}
+
+static void benchRun(int passes){
+	int p, i;
+	long long acc = 0;
+	long long before = wall_clock_time();
+	for(p = 0; p < passes; p++){
+		for(i = 0; i < CASES; i++){
+			struct benchCase * c = &cases[i];
+			int x = c->pos[X], y = c->pos[Y];
+			run(c->ball[X], c->ball[Y], &x, &y, c->speed);
+			acc += x + y;
+		}
+	}
+	report("run", (long long)passes*CASES, wall_clock_time() - before);
+	sink = acc;
+}
+
+static void benchDetermineShot(int passes, unsigned int seed){
+	int p, i;
+	long long acc = 0;
+	struct rngStream rng;
+	long long before = wall_clock_time();
+	for(p = 0; p < passes; p++){
+		rngStart(&rng, seed, 0, p, FP0);
+		for(i = 0; i < CASES; i++){
+			struct benchCase * c = &cases[i];
+			int shot[2];
+			determineShot(c->skill, c->pos, c->ball, shot, &rng);
+			acc += shot[X] + shot[Y];
+		}
+	}
+	report("determineShot", (long long)passes*CASES, wall_clock_time() - before);
+	sink = acc;
+}
+
+static void benchShotProbability(int passes){
+	int p, i;
+	float acc = 0;
+	long long before = wall_clock_time();
+	for(p = 0; p < passes; p++){
+		for(i = 0; i < CASES; i++)
+			acc += getShotProbability(cases[i].dist, cases[i].skill);
+	}
+	report("getShotProbability", (long long)passes*CASES, wall_clock_time() - before);
+	sink = (long long)acc;
+}
+
+//one player update per lane, every player over CASES matches with the ball shifting each pass
+static void benchLanes(int passes, int scalar){
+	static int ballX[2*CASES], ballY[2*CASES];
+	static int posX[CASES], posY[CASES], speed[CASES];
+	int p, i, rank;
+	long long acc = 0;
+	for(i = 0; i < 2*CASES; i++){
+		ballX[i] = cases[i%CASES].ball[X];
+		ballY[i] = cases[i%CASES].ball[Y];
+	}
+	for(i = 0; i < CASES; i++){
+		posX[i] = cases[i].pos[X];
+		posY[i] = cases[i].pos[Y];
+		speed[i] = cases[i].speed;
+	}
+	lanesForceScalar(scalar);
+	long long before = wall_clock_time();
+	for(p = 0; p < passes; p++){
+		rank = p % PLAYERS + 2;
+		lanesMove(rank, p % ROUNDS, CASES, ballX + p%CASES, ballY + p%CASES, posX, posY, speed);
+		acc += posX[p%CASES] + posY[p%CASES];
+	}
+	report(scalar || !lanesVector() ? "lanesMove_scalar" : "lanesMove_avx2", (long long)passes*CASES, wall_clock_time() - before);
+	lanesForceScalar(0);
+	sink = acc;
+}
+
+int main(int argc, char *argv[]){
+	int passes = 1000;
+	if(argc > 2 || (argc == 2 && (passes = atoi(argv[1])) <= 0)){
+		printf("usage: bench_game [passes]\n");
+		return 1;
+	}
+	makeCases(1);
+	int bad = checkKernels();
+	if(bad){
+		printf("%d results of the kernels differ from the rules\n", bad);
+		return 1;
+	}
+	printf("function,calls,ns_per_call\n");
+	benchRunStrategy(passes);
+	benchRun(passes);
+	benchDetermineShot(passes, 1);
+	benchShotProbability(passes);
+	benchLanes(passes, 1);
+	benchLanes(passes, 0);
+	return 0;
+}
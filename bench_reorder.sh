@@ -0,0 +1,26 @@
+#!/bin/sh
+# round latency with and without --reorder under a range of launcher binding policies.
+# usage: ./bench_reorder.sh [rounds] [policy ...]      e.g. ./bench_reorder.sh 5400 "--bind-to core" "--map-by node"
+# set MPIRUN to change the launcher, e.g. MPIRUN="mpirun --oversubscribe", and ROSTER to play a roster file
+# a policy the launcher refuses, such as binding more ranks than there are cores, shows as failed
+MPIRUN=${MPIRUN:-mpirun}
+RANKS=12
+ROSTERFLAG=""
+if [ -n "$ROSTER" ]; then
+	players=$(awk '{ sub(/#.*/, "") } $1 == "a" || $1 == "b" { n++ } END { print n+0 }' "$ROSTER") || exit 1
+	RANKS=$((2 + players))
+	ROSTERFLAG="--roster $ROSTER"
+fi
+ROUNDS=${1:-5400}
+[ $# -gt 0 ] && shift
+[ $# -eq 0 ] && set -- "--bind-to core" "--bind-to socket" "--map-by node" "--bind-to none"
+
+echo "policy,reorder,ranks,rounds,usec_per_round,placement"
+for policy in "$@"; do
+	for reorder in "" "--reorder"; do
+		out=$($MPIRUN $policy -np $RANKS ./match $ROSTERFLAG $reorder --rounds $ROUNDS --output binary --trace /dev/null --timing 2>&1 >/dev/null)
+		usec=$(echo "$out" | sed -n 's/.*, \([0-9.]*\) usec\/round/\1/p')
+		place=$(echo "$out" | sed -n 's/^placement: \([^,]*\), \([0-9]*\) of.*/\1 (\2 moved)/p')
+		echo "$policy,${reorder:-none},$RANKS,$ROUNDS,${usec:-failed},$place"
+	done
+done
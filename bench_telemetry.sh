@@ -0,0 +1,34 @@
+#!/bin/sh
+# cost of --telemetry: median round latency over interleaved runs with and without it.
+# usage: ./bench_telemetry.sh [runs] [rounds]      e.g. ./bench_telemetry.sh 21 5400
+# set MPIRUN to change the launcher, e.g. MPIRUN="mpirun --oversubscribe", and ROSTER to play a roster file
+MPIRUN=${MPIRUN:-mpirun}
+RANKS=12
+ROSTERFLAG=""
+if [ -n "$ROSTER" ]; then
+	players=$(awk '{ sub(/#.*/, "") } $1 == "a" || $1 == "b" { n++ } END { print n+0 }' "$ROSTER") || exit 1
+	RANKS=$((2 + players))
+	ROSTERFLAG="--roster $ROSTER"
+fi
+RUNS=${1:-9}
+ROUNDS=${2:-5400}
+OUT=$(mktemp)
+
+i=0
+while [ $i -lt $RUNS ]; do
+	for mode in off on; do
+		flag=""
+		[ $mode = on ] && flag="--telemetry bench_telemetry.$$"
+		usec=$($MPIRUN -np $RANKS ./match $ROSTERFLAG $flag --rounds $ROUNDS --output none --timing 2>&1 >/dev/null \
+			| sed -n 's/.*, \([0-9.]*\) usec\/round/\1/p')
+		echo "$mode $usec" >> $OUT
+	done
+	i=$((i+1))
+done
+
+echo "telemetry,runs,rounds,median_usec_per_round"
+for mode in off on; do
+	median=$(grep "^$mode " $OUT | cut -d' ' -f2 | sort -n | awk '{v[NR]=$1} END{print v[int((NR+1)/2)]}')
+	echo "$mode,$RUNS,$ROUNDS,$median"
+done
+rm -f $OUT
@@ -0,0 +1,32 @@
+#!/bin/sh
+# round latency of the --tiles layout as the number of field process tiles and of players grows.
+# usage: ./bench_tiles.sh [rounds] [grid ...]      e.g. ./bench_tiles.sh 5400 2x1 2x2 4x2 8x4
+# set MPIRUN to change the launcher, e.g. MPIRUN="mpirun --oversubscribe"
+# set PLAYERS to the player counts to sweep (default "10 20 40", at most 64). each count plays a roster
+# built from ROSTER (default roster.txt): its court, with its team a and b players repeated to fill each side
+MPIRUN=${MPIRUN:-mpirun}
+ROSTER=${ROSTER:-roster.txt}
+PLAYERS=${PLAYERS:-"10 20 40"}
+ROUNDS=${1:-5400}
+[ $# -gt 0 ] && shift
+GRIDS=${*:-"1x1 2x1 2x2 4x2 4x4"}
+OUT=${TMPDIR:-/tmp}/bench_tiles.$$
+
+echo "tiles,players,ranks,rounds,usec_per_round"
+for players in $PLAYERS; do
+	awk -v n=$players '
+		{ sub(/#.*/, "") }
+		$1 == "a" { a[na++] = $0; next }
+		$1 == "b" { b[nb++] = $0; next }
+		NF { print }
+		END { for(i = 0; i < int(n/2); i++) print a[i%na]; for(i = 0; i < n-int(n/2); i++) print b[i%nb] }' "$ROSTER" >$OUT.roster || exit 1
+	for grid in $GRIDS; do
+		cols=${grid%x*}
+		rows=${grid#*x}
+		ranks=$((cols*rows + players))
+		usec=$($MPIRUN -np $ranks ./match --tiles $grid --roster $OUT.roster --rounds $ROUNDS --output binary --trace /dev/null --timing 2>&1 >/dev/null \
+			| sed -n 's/.*, \([0-9.]*\) usec\/round/\1/p')
+		echo "$grid,$players,$ranks,$ROUNDS,${usec:-failed}"
+	done
+done
+rm -f $OUT.roster
@@ -0,0 +1,103 @@
+#include <stdio.h>
+#include <string.h>
+#include "checkpoint.h"
+
+#define CKPT_INTS(n) ((int)((n)/sizeof(int)))
+#define CKPT_SLOT_SIZE (sizeof(struct ckptHeader) + PLAYERS*sizeof(struct ckptPlayer))
+
+static MPI_Offset playerOffset(int slot, int id){
+	return slot*(MPI_Offset)CKPT_SLOT_SIZE + sizeof(struct ckptHeader) + (MPI_Offset)(id-2)*sizeof(struct ckptPlayer);
+}
+
+//collective over comm. empties the file first, so no slot of an earlier run is left in it to be restarted from.
+//returns nonzero, on every rank, if the file cannot be created
+int checkpointOpen(struct checkpointFile * c, MPI_Comm comm, const char * path){
+	c->written = 0;
+	c->pending = MPI_REQUEST_NULL;
+	if(MPI_File_open(comm, path, MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &c->file) != MPI_SUCCESS)
+		return 1;
+	if(MPI_File_set_size(c->file, 0) != MPI_SUCCESS
+		|| MPI_File_set_size(c->file, CKPT_SLOTS*(MPI_Offset)CKPT_SLOT_SIZE) != MPI_SUCCESS){
+		MPI_File_close(&c->file);
+		return 1;
+	}
+	return 0;
+}
+
+//waits for the last checkpoint to reach the file. returns nonzero if this rank's part failed
+int checkpointFinish(struct checkpointFile * c){
+	MPI_Status status;
+	return MPI_Wait(&c->pending, &status) != MPI_SUCCESS;
+}
+
+//collective over the file's comm. the rank passing a header writes it, every other rank writes its count
+//players, which must have contiguous ids. finishes the previous checkpoint, copies this one and starts
+//writing it. returns nonzero if this rank's part of the previous one failed
+int checkpointWrite(struct checkpointFile * c, int round, struct ckptHeader * h, struct ckptPlayer * players, int count){
+	int slot = c->written++ % CKPT_SLOTS;
+	int i, failed = checkpointFinish(c);
+	void * buf = c->players;
+	MPI_Offset offset = 0;
+	int ints = 0;
+	if(h != NULL){
+		c->header = *h;
+		c->header.magic = CKPT_MAGIC;
+		c->header.version = CKPT_VERSION;
+		c->header.players = PLAYERS;
+		c->header.round = round;
+		buf = &c->header;
+		offset = slot*(MPI_Offset)CKPT_SLOT_SIZE;
+		ints = CKPT_INTS(sizeof(c->header));
+	}
+	else if(count > 0){
+		memcpy(c->players, players, count*sizeof(struct ckptPlayer));
+		for(i = 0; i < count; i++)
+			c->players[i].round = round;
+		offset = playerOffset(slot, players[0].id);
+		ints = CKPT_INTS(count*sizeof(struct ckptPlayer));
+	}
+	if(MPI_File_iwrite_at_all(c->file, offset, buf, ints, MPI_INT, &c->pending) != MPI_SUCCESS)
+		failed = 1;
+	return failed;
+}
+
+//finishes the last checkpoint and closes the file. returns nonzero if this rank's part failed
+int checkpointClose(struct checkpointFile * c){
+	int failed = checkpointFinish(c);
+	MPI_File_close(&c->file);
+	return failed;
+}
+
+//collective over comm: every rank reads the header and players firstId..firstId+count-1 of the latest
+//slot that was written completely. returns nonzero, on every rank, if there is none
+int checkpointRead(MPI_Comm comm, const char * path, struct ckptHeader * h, struct ckptPlayer * players, int firstId, int count){
+	struct ckptHeader heads[CKPT_SLOTS];
+	struct ckptPlayer own[CKPT_SLOTS][MAX_PLAYERS];
+	int whole[CKPT_SLOTS];
+	MPI_File file;
+	int slot, i, err = MPI_SUCCESS, best = -1;
+	if(MPI_File_open(comm, path, MPI_MODE_RDONLY, MPI_INFO_NULL, &file) != MPI_SUCCESS)
+		return 1;
+	for(slot = 0; slot < CKPT_SLOTS; slot++){
+		if(err == MPI_SUCCESS)
+			err = MPI_File_read_at_all(file, slot*(MPI_Offset)CKPT_SLOT_SIZE, &heads[slot], CKPT_INTS(sizeof(struct ckptHeader)), MPI_INT, MPI_STATUS_IGNORE);
+		if(err == MPI_SUCCESS)
+			err = MPI_File_read_at_all(file, count > 0 ? playerOffset(slot, firstId) : 0, own[slot],
+				CKPT_INTS(count*sizeof(struct ckptPlayer)), MPI_INT, MPI_STATUS_IGNORE);
+		struct ckptHeader * sh = &heads[slot];
+		whole[slot] = err == MPI_SUCCESS && sh->magic == CKPT_MAGIC && sh->version == CKPT_VERSION && sh->players == PLAYERS;
+		for(i = 0; i < count && whole[slot]; i++)
+			whole[slot] = own[slot][i].round == sh->round && own[slot][i].id == firstId+i;
+	}
+	MPI_File_close(&file);
+	MPI_Allreduce(MPI_IN_PLACE, whole, CKPT_SLOTS, MPI_INT, MPI_MIN, comm);
+	for(slot = 0; slot < CKPT_SLOTS; slot++){
+		if(whole[slot] && (best < 0 || heads[slot].round > heads[best].round))
+			best = slot;
+	}
+	if(best < 0)
+		return 1;
+	*h = heads[best];
+	memcpy(players, own[best], count*sizeof(struct ckptPlayer));
+	return 0;
+}
@@ -0,0 +1,53 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <mpi.h>
+#include "game.h"
+
+//checkpoint file: two slots, written in turn, so a failure part way through a checkpoint leaves the one
+//before it intact. a slot is a header with what fp0 knows at the start of a round, then one record per
+//player in id order. every rank writes its own part with one nonblocking collective MPI-IO call into a file
+//that stays open for the whole match, and the write completes while the next rounds are played. the file is
+//emptied when the match opens it. players are stored by id, not by rank, so a match can restart under any
+//--comm, --tiles or --threads layout. the random streams are keyed by seed, match and round, so the header is
+//all the generator state there is
+#define CKPT_MAGIC 0x504b4242		//"BBKP"
+#define CKPT_VERSION 1
+#define CKPT_SLOTS 2
+
+struct ckptHeader{
+	int magic;
+	int version;
+	int players;
+	unsigned int seed;
+	int match;
+	int round;		//next round to play
+	int score[2];
+	int ballCoords[2];
+};
+
+struct ckptPlayer{
+	int round;		//same as the header's once the whole slot is written
+	int id;
+	int playerInfo[PLYR_INFO_SIZE];
+	int target;
+	int speed;
+	int dribbling;
+	int shooting;
+};
+
+struct checkpointFile{
+	MPI_File file;
+	int written;		//checkpoints so far, picks the next slot
+	MPI_Request pending;	//the write in flight, from its own copy of the state
+	struct ckptHeader header;
+	struct ckptPlayer players[MAX_PLAYERS];
+};
+
+int checkpointOpen(struct checkpointFile *, MPI_Comm, const char *);
+int checkpointWrite(struct checkpointFile *, int, struct ckptHeader *, struct ckptPlayer *, int);
+int checkpointFinish(struct checkpointFile *);
+int checkpointClose(struct checkpointFile *);
+int checkpointRead(MPI_Comm, const char *, struct ckptHeader *, struct ckptPlayer *, int, int);
+
+#endif
@@ -0,0 +1,525 @@
+#include <stdio.h>
+#include <time.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <sys/time.h>
+#include "game.h"
+#include "grid.h"
+
+long long wall_clock_time()
+{
+#ifdef __linux__
+	struct timespec tp;
+	clock_gettime(CLOCK_REALTIME, &tp);
+	return (long long)(tp.tv_nsec + (long long)tp.tv_sec * 1000000000ll);
+#else
+#warning "Your timer resolution might be too low. Compile on Linux and link with librt"
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return (long long)(tv.tv_usec * 1000 + (long long)tv.tv_sec * 1000000000ll);
+#endif
+}
+
+_Thread_local struct gameConfig game = {
+	.players = 10, .teamSize = 5,
+	.length = 128, .width = 64, .midX = 64, .midY = 32,
+	.zone = 20, .lane = 16, .three = 24,
+	.rounds = 5400, .half = 2700,
+	.shot = {60, 60}, .near = {5, 5},
+	.roster = {
+		{21, 48, 3, 10, 2, 0}, {21, 32, 3, 8, 4, 0}, {21, 16, 5, 7, 3, 0}, {41, 48, 10, 3, 2, 1}, {41, 16, 8, 1, 6, 1},
+		{107, 48, 7, 2, 6, 0}, {107, 32, 10, 4, 1, 0}, {107, 16, 3, 10, 2, 0}, {87, 48, 8, 2, 5, 1}, {87, 16, 5, 2, 8, 1}
+	}
+};
+
+//reads a roster file into game. lines are "court length width", "zone depth halfwidth", "three distance",
+//"rounds total halftime", "strategy a|b shotpercent near", or a player: "a|b x y speed dribbling shooting [chaser]". a '#' starts a comment.
+//team a's players take the ids before team b's, each team in file order. returns 0, -1 if the file cannot
+//be read, or the number of the first line that is not understood or breaks a limit
+int gameLoadRoster(const char * path){
+	struct gameConfig c = game;
+	struct rosterPlayer teams[2][MAX_PLAYERS];
+	int count[2] = {0, 0};
+	char line[256], key[16], word[16];
+	int n = 0, i;
+	FILE * f = fopen(path, "r");
+	if(f == NULL)
+		return -1;
+	while(fgets(line, sizeof(line), f) != NULL){
+		struct rosterPlayer p = {0};
+		char * hash = strchr(line, '#');
+		int ok;
+		n++;
+		if(hash != NULL)
+			*hash = '\0';
+		if(sscanf(line, "%15s", key) != 1)
+			continue;
+		if(strcmp(key, "court") == 0)
+			ok = sscanf(line, "%*s %d %d", &c.length, &c.width) == 2 && c.length > 0 && c.length <= MAX_LENGTH
+				&& c.width > 0 && c.width <= MAX_WIDTH;
+		else if(strcmp(key, "zone") == 0)
+			ok = sscanf(line, "%*s %d %d", &c.zone, &c.lane) == 2 && c.zone >= 0 && c.lane >= 0;
+		else if(strcmp(key, "three") == 0)
+			ok = sscanf(line, "%*s %d", &c.three) == 1 && c.three > 0;
+		else if(strcmp(key, "rounds") == 0)
+			ok = sscanf(line, "%*s %d %d", &c.rounds, &c.half) == 2 && c.rounds > 0 && c.half >= 0;
+		else if(strcmp(key, "strategy") == 0){
+			char team;
+			int shot, near;
+			ok = sscanf(line, "%*s %c %d %d", &team, &shot, &near) == 3 && (team == 'a' || team == 'b')
+				&& shot >= 0 && shot <= 100 && near >= 0;
+			if(ok){
+				c.shot[team-'a'] = shot;
+				c.near[team-'a'] = near;
+			}
+		}
+		else if(strcmp(key, "a") == 0 || strcmp(key, "b") == 0){
+			int t = key[0] - 'a';
+			int fields = sscanf(line, "%*s %d %d %d %d %d %15s", &p.x, &p.y, &p.speed, &p.dribbling, &p.shooting, word);
+			p.chaser = fields == 6 && strcmp(word, "chaser") == 0;
+			ok = (fields == 5 || p.chaser) && p.speed > 0 && p.dribbling >= 0 && p.shooting >= 0
+				&& p.speed + p.dribbling + p.shooting <= MAX_SKILL && count[0] + count[1] < MAX_PLAYERS;
+			if(ok)
+				teams[t][count[t]++] = p;
+		}
+		else
+			ok = 0;
+		if(!ok){
+			fclose(f);
+			return n;
+		}
+	}
+	fclose(f);
+	if(count[0] == 0 || count[1] == 0)
+		return n;
+	c.players = count[0] + count[1];
+	c.teamSize = count[0];
+	c.midX = c.length/2;
+	c.midY = c.width/2;
+	for(i = 0; i < c.players; i++){
+		struct rosterPlayer * p = i < count[0] ? &teams[0][i] : &teams[1][i-count[0]];
+		if(p->x < 0 || p->x > c.length || p->y < 0 || p->y > c.width)
+			return n;
+		c.roster[i] = *p;
+	}
+	game = c;
+	return 0;
+}
+
+//starting position and skills of the player with the given id, from the roster
+void initPlayer(int rank, int * playerInfo, int * speed, int * dribbling, int * shooting){
+	struct rosterPlayer * p = &game.roster[rank-2];
+	playerInfo[INIT_X] = playerInfo[END_X] = p->x;
+	playerInfo[INIT_Y] = playerInfo[END_Y] = p->y;
+	*speed = p->speed;
+	*dribbling = p->dribbling;
+	*shooting = p->shooting;
+	playerInfo[REACH_RND] = playerInfo[WIN_RND] = 0;
+	playerInfo[CHALLENGE] = playerInfo[SHOOT_X] = playerInfo[SHOOT_Y] = -1;
+}
+
+//player's move for the round, fills in playerMessage. returns 1 if the player reached the ball
+int playerTurn(int rank, int round, int * ballCoords, int * playerInfo, int * target, int speed, int dribbling, int shooting, int * playerMessage, struct rngStream * rng){
+	initInfo(playerInfo);			//init all variables
+	if(round >= HALF_TIME){
+		*target = TEAM(rank) == 0 ? 0 : LENGTH;
+	}
+	
+	//Apply run strategy
+	runStrategy(rank, round, ballCoords, playerInfo, playerInfo+2, speed);
+	
+	playerMessage[X] = playerInfo[END_X];
+	playerMessage[Y] = playerInfo[END_Y];
+	playerMessage[RANK] = rank;
+	playerMessage[SHOOT_SKILL] = shooting;
+	playerMessage[RND_NO] = round;
+	
+	//if reach ball send message with all fields set
+	if(playerInfo[END_X] == ballCoords[X] && playerInfo[END_Y] == ballCoords[Y]){
+		playerChallenge(rank, playerInfo[END_X], playerInfo[END_Y], *target, dribbling, shooting, playerMessage+CHAL_SCR, playerMessage+SHOT_TYPE, rng);
+			
+		//set my own player information
+		playerInfo[REACH_RND] = 1;
+		playerInfo[CHALLENGE] = playerMessage[CHAL_SCR];
+		return 1;
+	}
+	else{		//i did not reach the ball this round
+		playerMessage[CHAL_SCR] = -1;
+		playerMessage[SHOT_TYPE] = -1;
+		return 0;
+	}
+}
+
+//challenge score and shot type of player rank standing on the ball at x,y, attacking the basket at target
+void playerChallenge(int rank, int x, int y, int target, int dribbling, int shooting, int * challenge, int * shotType, struct rngStream * rng){
+	*challenge = (rngNext(rng) % 10 + 1) * dribbling;
+	
+	int dist = abs(x - target) + abs(y - game.midY);
+	//we determine what the shot type is (either we try to score, or we pass)
+	if(getShotProbability(dist, shooting) > game.shot[TEAM(rank)]/100.0)
+		*shotType = SCORE;
+	else
+		*shotType = PASS;
+}
+
+//field process with the ball resolves the challenge from the received player messages into ballChallengeInfo
+void resolveBallChallenge(int round, int * playerMessage, int * ballCoords, int * ballChallengeInfo, struct rngStream * rng){
+	int i, c;
+	int drawBuf[MAX_PROCESSES];
+	int drawCount = 0;
+	int winBallRank = -1;
+	int maxBallChallenge = -1;
+	struct playerGrid grid;
+	int challengers[MAX_PROCESSES];
+	
+	//only the players standing on the ball can have challenged for it
+	gridBuild(&grid, playerMessage);
+	int challengerCount = gridNear(&grid, playerMessage, ballCoords[X], ballCoords[Y], 0, challengers);
+	
+	//get max ball challenges, or find out if any draw in ball challenges
+	for(c = 0; c < challengerCount; c++){
+		i = challengers[c];
+		int * currPlayer = playerMessage+(i*PLYR_MSG_SIZE);
+		if(*currPlayer == -1)
+			continue;
+		if(*(currPlayer+CHAL_SCR) == -1){
+		}
+		else{
+			if(*(currPlayer+CHAL_SCR) > maxBallChallenge){
+				drawCount = 0;
+				maxBallChallenge = *(currPlayer+CHAL_SCR);
+				winBallRank = i;
+			}
+			else if(*(currPlayer+CHAL_SCR) == maxBallChallenge)
+				drawBuf[drawCount++] = i;
+		}
+	}
+	
+	if(drawCount > 1)		//if there's a draw, we pick 1 winner randomly
+			winBallRank = drawBuf[rngNext(rng) % drawCount];
+
+	if(winBallRank > 0){		//the winner of the ball challenge (-1 if no challenges)
+		int * winBallPlayer = playerMessage+(winBallRank*PLYR_MSG_SIZE);
+		int shotLocation[2] = {LENGTH, game.midY};
+		int points = 0;
+		//set player's scoring grid
+		if(round < HALF_TIME){
+			if(TEAM(winBallRank) == 1)
+				shotLocation[X] = 0;
+		}
+		else{
+			if(TEAM(winBallRank) == 0)
+				shotLocation[X] = 0;
+		}
+		int distToGoal = abs(*(winBallPlayer+X) - shotLocation[X]) + abs(*(winBallPlayer+Y) - shotLocation[Y]);
+		
+		//if the ball is already at the scoring grid, we simply add 2 points
+		if(*(winBallPlayer+X) == shotLocation[X] && *(winBallPlayer+Y) == shotLocation[Y])
+			points = 2;
+		else{
+			if(*(winBallPlayer+SHOT_TYPE) == SCORE){		//if the player wishes to score
+				determineShot(*(winBallPlayer+SHOOT_SKILL), winBallPlayer, shotLocation, ballCoords, rng);						
+			}
+			else{		//player wishes to pass
+				//we find teammate closest to score grid
+				int * targetTeammate = winBallPlayer;
+				int teammate = gridNearestTeammate(&grid, playerMessage, shotLocation[X], shotLocation[Y], TEAM(winBallRank), round, distToGoal-1);
+				//the shot below is taken with the last teammate of the team's rank range, as the original linear scan left it
+				int * currPlayer = playerMessage+((TEAM(winBallRank) == 0 ? game.teamSize+1 : PROCESSES-1)*PLYR_MSG_SIZE);
+				
+				if(teammate > 0){
+					targetTeammate = playerMessage+(teammate*PLYR_MSG_SIZE);
+					distToGoal = abs(*(targetTeammate+X)-shotLocation[X])+abs(*(targetTeammate+Y)-shotLocation[Y]);
+					shotLocation[X] = *(targetTeammate+X);
+					shotLocation[Y] = *(targetTeammate+Y);
+				}
+				
+				if(targetTeammate == winBallPlayer)	//already the player with ball is already nearest to score grid, he tries his luck
+					determineShot(*(winBallPlayer+SHOOT_SKILL), winBallPlayer, shotLocation, ballCoords, rng);			
+				else{
+					determineShot(*(currPlayer+SHOOT_SKILL), currPlayer, shotLocation, ballCoords, rng);			
+				}
+			}
+
+			//determine score
+			if(ballCoords[Y] == game.midY && (ballCoords[X] == LENGTH || ballCoords[X] == 0)){
+				points = distToGoal < game.three ? 2 : 3;
+				ballCoords[X] = game.midX;	//start from center after scoring
+				ballCoords[Y] = game.midY;
+			}
+		}
+		
+		//message to sync information between field processes
+		ballChallengeInfo[0] = winBallRank;
+		ballChallengeInfo[1] = shotLocation[0];
+		ballChallengeInfo[2] = shotLocation[1];
+		ballChallengeInfo[3] = ballCoords[0];
+		ballChallengeInfo[4] = ballCoords[1];
+		ballChallengeInfo[5] = points;
+		ballChallengeInfo[6] = TEAM(winBallRank);
+	}
+	else{	//no ball challenges
+		ballChallengeInfo[0] = winBallRank;
+		ballChallengeInfo[1] = -1;
+		ballChallengeInfo[2] = -1;
+		ballChallengeInfo[3] = ballCoords[0];
+		ballChallengeInfo[4] = ballCoords[1];
+		ballChallengeInfo[5] = 0;
+		ballChallengeInfo[6] = -1;
+	}
+}
+
+//function to reset round variables of a player
+void initInfo(int * info){
+	*(info+INIT_X) = *(info+END_X);
+	*(info+INIT_Y) = *(info+END_Y);
+	*(info+REACH_RND) = *(info+WIN_RND) = 0;
+	*(info+CHALLENGE) = *(info+SHOOT_X) = *(info+SHOOT_Y) = -1;
+}
+
+void runStrategy(int rank, int round, int * ballCoords, int * startPos, int * endPos, int speed){
+	if(isChaser(rank)){		//designated ball chasers
+		runTowardsBall(*ballCoords, *(ballCoords+1), *startPos, *(startPos+1), endPos, endPos+1, speed);
+	}
+	else{
+		if(nearBall(startPos, ballCoords, game.near[TEAM(rank)]*speed)){
+			runTowardsBall(*ballCoords, *(ballCoords+1), *startPos, *(startPos+1), endPos, endPos+1, speed);
+		}
+		else{
+			if(isOffenseSide(rank, ballCoords, round)){	//if ball is in my attacking half, run towards my attacking half
+				runOffenseDirection(rank, round, *(startPos), *(startPos+1), endPos, endPos+1, speed);
+			}
+			else{ //else run towards my defensive half
+				runDefenseDirection(rank, round, *(startPos), *(startPos+1), endPos, endPos+1, speed);
+			}
+		}
+	}
+}
+
+int isChaser(int rank){
+	return game.roster[rank-2].chaser;
+}
+
+//function checks if player is within radius of the ball
+int nearBall(int * location, int * ballLocation, int radius){
+	int totalDist = abs(*location - *ballLocation) + abs(*(location+1) - *(ballLocation+1));
+	if(totalDist < radius)
+		return 1;
+	else
+		return 0;
+}
+
+//functions return true if ball is in player's offensive side, and false otherwise
+int isOffenseSide(int rank, int * ball, int round){
+	if(round < HALF_TIME){
+		if(TEAM(rank) == 0)	//attack right side
+			return *ball <= game.midX ? 0 : 1;
+		else		//attack left side
+			return *ball > game.midX ? 0 : 1;
+	}
+	else{
+		if(TEAM(rank) == 0)
+			return *ball <= game.midX ? 1 : 0;
+		else
+			return *ball > game.midX ? 1 : 0;
+	}
+}
+
+void runOffenseDirection(int rank, int round, int currX, int currY, int *resultX, int * resultY, int distance){
+	//if already in offense zone, stay
+	if(round < HALF_TIME){
+		if(TEAM(rank) == 0){	//attack right side
+			if(currX < LENGTH-game.zone || abs(currY - game.midY) > game.lane)
+				run(LENGTH,game.midY,resultX,resultY,distance);
+		}
+		else{	//attack left side
+			if(currX > game.zone || abs(currY - game.midY) > game.lane)
+				run(0,game.midY,resultX,resultY,distance);
+		}
+	}
+	else{
+		if(TEAM(rank) == 0){	//attack left side
+			if(currX > game.zone || abs(currY - game.midY) > game.lane)
+				run(0,game.midY,resultX,resultY,distance);
+		}
+		else{
+			if(currX < LENGTH-game.zone || abs(currY - game.midY) > game.lane)
+				run(LENGTH,game.midY,resultX,resultY,distance);
+		}
+	}
+}
+
+void runDefenseDirection(int rank, int round, int currX, int currY, int *resultX, int * resultY, int distance){
+	//if already in defense zone, stay
+	if(round < HALF_TIME){
+		if(TEAM(rank) == 0){	//attack right side
+			if(currX > game.zone || abs(currY - game.midY) > game.lane){
+				run(0,game.midY,resultX,resultY,distance);
+			}
+		}
+		else{	//attack left side
+			if(currX < LENGTH-game.zone || abs(currY - game.midY) > game.lane)
+				run(LENGTH,game.midY,resultX,resultY,distance);
+		}
+	}
+	else{
+		if(TEAM(rank) == 0){	//attack left side
+			if(currX < LENGTH-game.zone || abs(currY - game.midY) > game.lane)
+				run(LENGTH,game.midY,resultX,resultY,distance);
+		}
+		else{
+			if(currX > game.zone || abs(currY - game.midY) > game.lane)
+				run(0,game.midY,resultX,resultY,distance);		
+		}
+	}
+}
+
+int inMyField(int * location){
+	return *location <= game.midX ? FP0 : FP1;
+}
+
+void determineShot(int shootSkill, int * ballCoords, int * shotCoords, int * output, struct rngStream * rng){
+	//get shot probability
+	int distance = abs(*ballCoords-*shotCoords) + abs((*ballCoords+1)-(*shotCoords+1));
+	float probability = getShotProbability(distance, shootSkill);
+	//draw if good shot, set output and return
+	float shotProb = (float)rngNext(rng)/(float)RNG_MAX;
+	if(shotProb <= probability){
+		*output = *shotCoords;
+		*(output+1) = *(shotCoords+1);
+	}
+	else{
+		int ranLocation = (rngNext(rng) % 8) + 1;
+		int minus = rngNext(rng) % 2;
+		*output = *shotCoords + (ranLocation/2 * (minus==0?-1:1));
+		minus = rngNext(rng) % 2;
+		*(output+1) = *(shotCoords+1) + (ranLocation/2 * (minus==0?-1:1));
+		
+		//check for bounds
+		if(*output > LENGTH){
+			*output = LENGTH-game.zone;
+		} else if(*output < 0){
+			*output = game.zone;
+		}
+		
+		if(*(output+1) > WIDTH){
+			*(output+1) = WIDTH;
+		} else if(*(output+1) < 0){
+			*(output+1) = 0;
+		}
+	}
+}
+
+//denominator of getShotProbability for every distance a court allows, so the pow is paid once at startup
+#define SHOT_TABLE (2*MAX_LENGTH+MAX_WIDTH+1)
+static double shotDenominator[SHOT_TABLE];
+
+__attribute__((constructor)) static void shotTableInit(void){
+	int d;
+	for(d = 0; d < SHOT_TABLE; d++)
+		shotDenominator[d] = 0.5*d*pow(d,0.5)-0.5;
+}
+
+float getShotProbability(int d, int s){
+	double den = d >= 0 && d < SHOT_TABLE ? shotDenominator[d] : 0.5*d*pow(d,0.5)-0.5;
+	float ratio = (10.0+90.0*s)/den;
+	return ratio < 100 ? ratio/100.0 : 1;
+}
+
+int runTowardsBall(int ballX, int ballY, int currX, int currY, int *resultX, int *resultY, int distance){
+	int offsetX = ballX - currX;
+	int offsetY = ballY - currY;
+	int distFromBall = abs(offsetX) + abs(offsetY);
+	
+	if(distance >= distFromBall){
+		*resultX = ballX;
+		*resultY = ballY;
+		return distFromBall;
+	}
+	else{
+		run(ballX, ballY, resultX, resultY, distance);
+		return distance;
+	}	
+}
+
+//one round of running towards destX,destY in closed form: diagonal while both axes are open with an odd last
+//unit going to x, then straight along the open axis. a player that gets there with distance left steps off
+//and back on along y, so it ends distance-left parity above destY, as the unit by unit walk did
+void run(int destX, int destY, int *currX, int *currY, int distance){
+	int dx = abs(destX - *currX);
+	int dy = abs(destY - *currY);
+	int signX = *currX > destX ? -1 : 1;
+	int signY = *currY > destY ? -1 : 1;
+	int diag = dx < dy ? dx : dy;
+	
+	if(distance < 2*diag){
+		*currX += signX*((distance+1)/2);
+		*currY += signY*(distance/2);
+		return;
+	}
+	int left = distance - 2*diag;
+	int moveX = left < dx-diag ? left : dx-diag;	//one of the two is 0
+	int moveY = left < dy-diag ? left : dy-diag;
+	left -= moveX + moveY;
+	*currX += signX*(diag+moveX);
+	*currY += signY*(diag+moveY) + (left & 1);
+}
+
+int fieldProcess(int * coords){
+	return (*coords <= game.midX) ? FP0 : FP1;
+}
+
+//field process tile owning the given coordinates when the court is split into a cols x rows grid.
+//a 2x1 grid is the fp0/fp1 split of fieldProcess
+int fieldTile(int * coords, int cols, int rows){
+	int col = *coords * cols / (LENGTH+1);
+	int row = *(coords+1) * rows / (WIDTH+1);
+	return row*cols + col;
+}
+
+//k rounds of run() towards a fixed destination in closed form.
+//Precondition: k*distance will not reach destX and destY
+void runRounds(int destX, int destY, int *currX, int *currY, int distance, int k){
+	int dx = abs(destX - *currX);
+	int dy = abs(destY - *currY);
+	int signX = *currX > destX ? -1 : 1;
+	int signY = *currY > destY ? -1 : 1;
+	int stepX = (distance+1)/2;	//a round with both axes open moves diagonally, an odd last unit goes to x
+	int stepY = distance/2;
+	int clean = 0;
+	
+	if(k <= 0)
+		return;
+	//rounds that keep both axes open from start to end
+	if(dx != 0 && dy != 0){
+		clean = dx/stepX;
+		if(stepY > 0 && dy/stepY < clean)
+			clean = dy/stepY;
+		if(k < clean)
+			clean = k;
+	}
+	*currX += signX*stepX*clean;
+	*currY += signY*stepY*clean;
+	k -= clean;
+	if(k == 0)
+		return;
+	//one round closes an axis, after that the player runs straight
+	run(destX, destY, currX, currY, distance);
+	k--;
+	if(*currX == destX)
+		*currY += signY*distance*k;
+	else
+		*currX += signX*distance*k;
+}
+
+//goal point a player runs to when it is not chasing the ball, and whether it has arrived in that zone and stands still.
+//mirrors runOffenseDirection and runDefenseDirection
+int goalPoint(int rank, int round, int * ballCoords, int currX, int currY, int * destX, int * destY){
+	int offense = isOffenseSide(rank, ballCoords, round);
+	*destX = ((TEAM(rank) == 0) == (round < HALF_TIME)) == offense ? LENGTH : 0;
+	*destY = game.midY;
+	if(abs(currY - game.midY) > game.lane)
+		return 0;
+	return *destX == LENGTH ? currX >= LENGTH-game.zone : currX <= game.zone;
+}
@@ -0,0 +1,106 @@
+#ifndef GAME_H
+#define GAME_H
+
+#include "rng.h"
+
+//storage is sized for the largest roster, loops and messages only cover the one loaded
+#define MAX_PLAYERS 64
+#define MAX_PROCESSES (MAX_PLAYERS+2)
+#define MAX_LENGTH 1024
+#define MAX_WIDTH 512
+#define MAX_SKILL 3276		//speed+dribbling+shooting of a player: a challenge is up to 10*dribbling and traces keep it in 16 bits
+
+//one roster entry: where the player starts, its skills, and whether it always chases the ball
+struct rosterPlayer{
+	int x;
+	int y;
+	int speed;
+	int dribbling;
+	int shooting;
+	int chaser;
+};
+
+//court, match length and roster, the built in game unless --roster loads one. team a is ids 2..teamSize+1,
+//team b the ids after it. plain ints, so match broadcasts it as bytes. game is thread local, so season workers
+//can each play a different roster: any other thread a rank starts copies in its starter's game first
+struct gameConfig{
+	int players;
+	int teamSize;
+	int length;
+	int width;
+	int midX;		//half court line, and where the ball restarts
+	int midY;		//baskets are at (0,midY) and (length,midY)
+	int zone;		//depth of the zone in front of a basket a player stops in
+	int lane;		//half the width of that zone
+	int three;		//shots from this far out score 3
+	int rounds;
+	int half;		//round the teams change ends
+	int shot[2];		//per team, percent shot probability above which a player on the ball shoots instead of passing
+	int near[2];		//per team, a player that is not a chaser runs for the ball within near*speed of it
+	struct rosterPlayer roster[MAX_PLAYERS];
+};
+
+extern _Thread_local struct gameConfig game;
+
+#define PLAYERS (game.players)
+#define PROCESSES (game.players+2)
+#define LENGTH (game.length)
+#define WIDTH (game.width)
+#define LENGTH_HALF (game.midX)
+#define ROUNDS (game.rounds)
+#define HALF_TIME (game.half)
+#define TEAM(id) ((id) < game.teamSize+2 ? 0 : 1)
+
+#define FP0 0
+#define FP1 1
+
+#define X 0
+#define Y 1
+
+#define SCORE 0
+#define PASS 1
+
+#define PLYR_MSG_SIZE 7
+#define RANK 2
+#define CHAL_SCR 3
+#define SHOT_TYPE 4
+#define SHOOT_SKILL 5
+#define RND_NO 6
+
+#define PLYR_INFO_SIZE 9
+#define INIT_X 0
+#define INIT_Y 1
+#define END_X 2
+#define END_Y 3
+#define REACH_RND 4
+#define WIN_RND 5
+#define CHALLENGE 6
+#define SHOOT_X 7
+#define SHOOT_Y 8
+
+#define CACHE_LINE 64
+
+long long wall_clock_time();
+int gameLoadRoster(const char *);
+void initPlayer(int, int *, int *, int *, int *);
+int playerTurn(int, int, int *, int *, int *, int, int, int, int *, struct rngStream *);
+void playerChallenge(int, int, int, int, int, int, int *, int *, struct rngStream *);
+void resolveBallChallenge(int, int *, int *, int *, struct rngStream *);
+void initInfo(int *);
+int nearBall(int *, int *, int);
+void runStrategy(int, int, int*, int*, int*, int);
+int runTowardsBall(int, int, int, int, int*, int*, int);
+void run(int, int, int*, int*, int);
+void runOffenseDirection(int, int, int, int, int *, int *, int);
+void runDefenseDirection(int, int, int, int, int *, int *, int);
+void determineShot(int, int *, int *, int *, struct rngStream *);
+float getShotProbability(int, int);
+int inMyField(int *);
+int fieldProcess(int *);
+int fieldTile(int *, int, int);
+int isChaser(int);
+void runRounds(int, int, int *, int *, int, int);
+int goalPoint(int, int, int *, int, int, int *, int *);
+int isOffenseSide(int, int*, int);
+
+#endif
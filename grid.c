@@ -0,0 +1,121 @@
+#include <stdlib.h>
+#include <string.h>
+#include "grid.h"
+
+static int gridCell(int x, int y){
+	return (y/GRID_CELL)*GRID_COLS + x/GRID_CELL;
+}
+
+static int onCourt(int * currPlayer){
+	return *(currPlayer+X) >= 0 && *(currPlayer+X) <= LENGTH && *(currPlayer+Y) >= 0 && *(currPlayer+Y) <= WIDTH;
+}
+
+//index the players 2..PROCESSES-1 of a field process's playerMessage block, skipping dummies
+void gridBuild(struct playerGrid * g, int * playerMessage){
+	int i, c;
+	g->linear = PLAYERS < GRID_MIN_PLAYERS;
+	if(g->linear)
+		return;
+	
+	int count[GRID_MAX_CELLS+1];
+	memset(count, 0, (GRID_CELLS+1)*sizeof(int));
+	for(i = 2; i < PROCESSES; i++){
+		int * currPlayer = playerMessage+(i*PLYR_MSG_SIZE);
+		if(onCourt(currPlayer))
+			count[gridCell(*(currPlayer+X), *(currPlayer+Y))+1]++;
+	}
+	g->cellStart[0] = 0;
+	for(c = 0; c < GRID_CELLS; c++){
+		g->cellStart[c+1] = g->cellStart[c] + count[c+1];
+		count[c+1] = g->cellStart[c];		//reused as the fill position of cell c
+	}
+	for(i = 2; i < PROCESSES; i++){
+		int * currPlayer = playerMessage+(i*PLYR_MSG_SIZE);
+		if(onCourt(currPlayer))
+			g->entries[count[gridCell(*(currPlayer+X), *(currPlayer+Y))+1]++] = i;
+	}
+}
+
+//ids of the players within Manhattan distance radius of (x,y), in ascending id. returns how many
+int gridNear(struct playerGrid * g, int * playerMessage, int x, int y, int radius, int * out){
+	int n = 0;
+	int cx, cy, e;
+	if(g->linear){
+		for(e = 2; e < PROCESSES; e++){
+			int * currPlayer = playerMessage+(e*PLYR_MSG_SIZE);
+			if(onCourt(currPlayer) && abs(*(currPlayer+X)-x) + abs(*(currPlayer+Y)-y) <= radius)
+				out[n++] = e;
+		}
+		return n;
+	}
+	int minX = (x-radius < 0 ? 0 : x-radius)/GRID_CELL;
+	int maxX = (x+radius > LENGTH ? LENGTH : x+radius)/GRID_CELL;
+	int minY = (y-radius < 0 ? 0 : y-radius)/GRID_CELL;
+	int maxY = (y+radius > WIDTH ? WIDTH : y+radius)/GRID_CELL;
+	for(cy = minY; cy <= maxY; cy++){
+		for(cx = minX; cx <= maxX; cx++){
+			int c = cy*GRID_COLS + cx;
+			for(e = g->cellStart[c]; e < g->cellStart[c+1]; e++){
+				int * currPlayer = playerMessage+(g->entries[e]*PLYR_MSG_SIZE);
+				if(abs(*(currPlayer+X)-x) + abs(*(currPlayer+Y)-y) <= radius){
+					//keep ascending id across cells
+					int k = n++;
+					while(k > 0 && out[k-1] > g->entries[e]){
+						out[k] = out[k-1];
+						k--;
+					}
+					out[k] = g->entries[e];
+				}
+			}
+		}
+	}
+	return n;
+}
+
+//teammate of the given team (see TEAM) who sent a message this round and is closest to (x,y),
+//no further than maxDist. ties go to the lowest id, as a linear scan would. returns -1 if there is none.
+//cells are visited in rings around (x,y); a cell k rings out is at least (k-1)*GRID_CELL+1 away
+int gridNearestTeammate(struct playerGrid * g, int * playerMessage, int x, int y, int team, int round, int maxDist){
+	int best = -1;
+	int bestDist = maxDist;
+	int cx0 = (x < 0 ? 0 : x > LENGTH ? LENGTH : x)/GRID_CELL;
+	int cy0 = (y < 0 ? 0 : y > WIDTH ? WIDTH : y)/GRID_CELL;
+	int i, k, cx, cy, e;
+	if(g->linear){
+		for(i = 2; i < PROCESSES; i++){
+			int * currPlayer = playerMessage+(i*PLYR_MSG_SIZE);
+			int dist = abs(*(currPlayer+X)-x) + abs(*(currPlayer+Y)-y);
+			if(TEAM(i) == team && *(currPlayer+RND_NO) == round && (dist < bestDist || (dist == bestDist && best == -1))){
+				bestDist = dist;
+				best = i;
+			}
+		}
+		return best;
+	}
+	for(k = 0; k < GRID_COLS || k < GRID_ROWS; k++){
+		if(k > 0 && (k-1)*GRID_CELL+1 > bestDist)
+			break;
+		for(cy = cy0-k; cy <= cy0+k; cy++){
+			if(cy < 0 || cy >= GRID_ROWS)
+				continue;
+			int step = (cy == cy0-k || cy == cy0+k) ? 1 : 2*k;	//only the ring's edge
+			for(cx = cx0-k; cx <= cx0+k; cx += step){
+				if(cx < 0 || cx >= GRID_COLS)
+					continue;
+				int c = cy*GRID_COLS + cx;
+				for(e = g->cellStart[c]; e < g->cellStart[c+1]; e++){
+					i = g->entries[e];
+					int * currPlayer = playerMessage+(i*PLYR_MSG_SIZE);
+					if(TEAM(i) != team || *(currPlayer+RND_NO) != round)
+						continue;
+					int dist = abs(*(currPlayer+X)-x) + abs(*(currPlayer+Y)-y);
+					if(dist < bestDist || (dist == bestDist && (best == -1 || i < best))){
+						bestDist = dist;
+						best = i;
+					}
+				}
+			}
+		}
+	}
+	return best;
+}
@@ -0,0 +1,29 @@
+#ifndef GRID_H
+#define GRID_H
+
+#include "game.h"
+
+//uniform grid over the player positions a field process received, rebuilt each round with a counting sort.
+//queries only visit the cells around the point they ask about
+#define GRID_CELL 8
+#define GRID_COLS (LENGTH/GRID_CELL+1)		//for the loaded court
+#define GRID_ROWS (WIDTH/GRID_CELL+1)
+#define GRID_CELLS (GRID_COLS*GRID_ROWS)
+#define GRID_MAX_CELLS ((MAX_LENGTH/GRID_CELL+1)*(MAX_WIDTH/GRID_CELL+1))
+
+//with fewer players than this, a plain scan beats building the cells, so the queries just scan
+#ifndef GRID_MIN_PLAYERS
+#define GRID_MIN_PLAYERS 32
+#endif
+
+struct playerGrid{
+	int linear;
+	int cellStart[GRID_MAX_CELLS+1];	//players of cell c are entries[cellStart[c]..cellStart[c+1]-1], in ascending id
+	int entries[MAX_PROCESSES];
+};
+
+void gridBuild(struct playerGrid *, int *);
+int gridNear(struct playerGrid *, int *, int, int, int, int *);
+int gridNearestTeammate(struct playerGrid *, int *, int, int, int, int, int);
+
+#endif
@@ -0,0 +1,85 @@
+#include <sched.h>
+#include "host.h"
+
+static void barrierWait(struct playerHost * h, int * localSense){
+	int spins = 0;
+	*localSense = !*localSense;
+	if(atomic_fetch_add_explicit(&h->count, 1, memory_order_acq_rel) == h->players-1){
+		atomic_store_explicit(&h->count, 0, memory_order_relaxed);
+		atomic_store_explicit(&h->sense, *localSense, memory_order_release);
+		return;
+	}
+	while(atomic_load_explicit(&h->sense, memory_order_acquire) != *localSense){
+		if(++spins > HOST_SPINS)
+			sched_yield();
+	}
+}
+
+//one player's turn, keyed by its own id so the match is the same as with a rank per player
+static void hostTurn(struct playerHost * h, int slot){
+	struct rngStream rng;
+	int id = h->firstId + slot;
+	rngStart(&rng, h->seed, h->match, h->round, id);
+	playerTurn(id, h->round, h->ballCoords, h->playerInfo+slot*PLYR_INFO_SIZE, &h->target[slot], h->speed[slot],
+		h->dribbling[slot], h->shooting[slot], h->playerMessage+slot*PLYR_MSG_SIZE, &rng);
+}
+
+static void * hostLoop(void * arg){
+	struct hostPlayer * p = arg;
+	struct playerHost * h = p->host;
+	int sense = 0;
+	game = *h->config;
+	for(;;){
+		barrierWait(h, &sense);		//round published
+		if(h->stop)
+			break;
+		hostTurn(h, p->slot);
+		barrierWait(h, &sense);		//every move done
+	}
+	return NULL;
+}
+
+//sets up players firstId.. and starts a thread for all but the first, which the caller plays.
+//returns nonzero if a thread cannot be started
+int hostStart(struct playerHost * h, int firstId, int players, unsigned int seed, int match){
+	int i;
+	atomic_init(&h->count, 0);
+	atomic_init(&h->sense, 0);
+	h->config = &game;
+	h->players = players;
+	h->firstId = firstId;
+	h->seed = seed;
+	h->match = match;
+	h->stop = 0;
+	h->mainSense = 0;
+	for(i = 0; i < players; i++){
+		int id = firstId + i;
+		initPlayer(id, h->playerInfo+i*PLYR_INFO_SIZE, &h->speed[i], &h->dribbling[i], &h->shooting[i]);
+		h->target[i] = TEAM(id) == 0 ? LENGTH : 0;
+		h->threads[i].host = h;
+		h->threads[i].slot = i;
+	}
+	for(i = 1; i < players; i++){
+		if(pthread_create(&h->threads[i].thread, NULL, hostLoop, &h->threads[i]))
+			return 1;
+	}
+	return 0;
+}
+
+//plays one round for every hosted player. returns once all messages and infos are filled in
+void hostMove(struct playerHost * h, int round, int * ballCoords){
+	h->round = round;
+	h->ballCoords[X] = ballCoords[X];
+	h->ballCoords[Y] = ballCoords[Y];
+	barrierWait(h, &h->mainSense);
+	hostTurn(h, 0);
+	barrierWait(h, &h->mainSense);
+}
+
+void hostStop(struct playerHost * h){
+	int i;
+	h->stop = 1;
+	barrierWait(h, &h->mainSense);
+	for(i = 1; i < h->players; i++)
+		pthread_join(h->threads[i].thread, NULL);
+}
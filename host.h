@@ -0,0 +1,44 @@
+#ifndef HOST_H
+#define HOST_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include "game.h"
+
+//--threads: one rank hosts several players as threads. each round the rank's main thread publishes
+//the ball, every player moves into its own slot of the shared message and info arrays, and a
+//sense-reversing barrier hands the round over in both directions instead of mpi messages
+#define HOST_SPINS 1024		//barrier spins before yielding the cpu
+
+struct hostPlayer{
+	struct playerHost * host;
+	int slot;		//index into the host's arrays, 0 is the main thread
+	pthread_t thread;
+};
+
+struct playerHost{
+	_Alignas(CACHE_LINE) atomic_int count;		//threads arrived at the barrier
+	_Alignas(CACHE_LINE) atomic_int sense;		//flips when the last one arrives
+	_Alignas(CACHE_LINE) int players;
+	int firstId;		//ids firstId..firstId+players-1, contiguous so each array goes out in one message
+	const struct gameConfig * config;		//the rank's game, copied into each player thread
+	unsigned int seed;
+	int match;
+	int round;
+	int stop;
+	int mainSense;
+	int ballCoords[2];
+	int playerInfo[MAX_PLAYERS*PLYR_INFO_SIZE];
+	int playerMessage[MAX_PLAYERS*PLYR_MSG_SIZE];
+	int target[MAX_PLAYERS];
+	int speed[MAX_PLAYERS];
+	int dribbling[MAX_PLAYERS];
+	int shooting[MAX_PLAYERS];
+	struct hostPlayer threads[MAX_PLAYERS];
+};
+
+int hostStart(struct playerHost *, int, int, unsigned int, int);
+void hostMove(struct playerHost *, int, int *);
+void hostStop(struct playerHost *);
+
+#endif
@@ -0,0 +1,120 @@
+#include <stdlib.h>
+#include "game.h"
+#include "lanes.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define LANES_AVX2
+#include <immintrin.h>
+#endif
+
+static int cpuVector = -1;
+static int forceScalar = 0;
+
+//1 if lanesMove takes the avx2 kernel on this cpu
+int lanesVector(void){
+#ifdef LANES_AVX2
+	if(cpuVector < 0)
+		cpuVector = __builtin_cpu_supports("avx2") ? 1 : 0;
+	return cpuVector && !forceScalar;
+#else
+	return 0;
+#endif
+}
+
+//makes lanesMove use the scalar path even where avx2 is there, for comparing the two
+void lanesForceScalar(int on){
+	forceScalar = on;
+}
+
+static void moveScalar(int rank, int round, int from, int n, const int * ballX, const int * ballY, int * posX, int * posY, const int * speed){
+	int m;
+	for(m = from; m < n; m++){
+		int ball[2] = {ballX[m], ballY[m]};
+		int start[2] = {posX[m], posY[m]};
+		int end[2] = {posX[m], posY[m]};
+		runStrategy(rank, round, ball, start, end, speed[m]);
+		posX[m] = end[X];
+		posY[m] = end[Y];
+	}
+}
+
+#ifdef LANES_AVX2
+//run() on 8 lanes. both of its cases are computed and the short run one, where both axes stay open, is blended in
+__attribute__((target("avx2"))) static inline void runLanes(__m256i destX, __m256i destY, __m256i * x, __m256i * y, __m256i distance){
+	__m256i one = _mm256_set1_epi32(1);
+	__m256i dx = _mm256_abs_epi32(_mm256_sub_epi32(destX, *x));
+	__m256i dy = _mm256_abs_epi32(_mm256_sub_epi32(destY, *y));
+	__m256i signX = _mm256_or_si256(_mm256_cmpgt_epi32(*x, destX), one);		//-1 or 1
+	__m256i signY = _mm256_or_si256(_mm256_cmpgt_epi32(*y, destY), one);
+	__m256i diag = _mm256_min_epi32(dx, dy);
+	__m256i shortRun = _mm256_cmpgt_epi32(_mm256_add_epi32(diag, diag), distance);
+
+	__m256i left = _mm256_sub_epi32(distance, _mm256_add_epi32(diag, diag));
+	__m256i moveX = _mm256_min_epi32(left, _mm256_sub_epi32(dx, diag));
+	__m256i moveY = _mm256_min_epi32(left, _mm256_sub_epi32(dy, diag));
+	left = _mm256_sub_epi32(left, _mm256_add_epi32(moveX, moveY));
+
+	__m256i stepX = _mm256_blendv_epi8(_mm256_add_epi32(diag, moveX), _mm256_srli_epi32(_mm256_add_epi32(distance, one), 1), shortRun);
+	__m256i stepY = _mm256_blendv_epi8(_mm256_add_epi32(diag, moveY), _mm256_srli_epi32(distance, 1), shortRun);
+	*x = _mm256_add_epi32(*x, _mm256_sign_epi32(stepX, signX));
+	*y = _mm256_add_epi32(*y, _mm256_sign_epi32(stepY, signY));
+	*y = _mm256_add_epi32(*y, _mm256_andnot_si256(shortRun, _mm256_and_si256(left, one)));
+}
+
+//runStrategy on 8 matches per step, without branches: both the run at the ball and the run to the goal point
+//are computed and the one the player takes is blended in. returns the first match it did not do
+__attribute__((target("avx2"))) static int moveAvx2(int rank, int n, const int * ballX, const int * ballY, int * posX, int * posY, const int * speed){
+	__m256i chaser = _mm256_set1_epi32(isChaser(rank) ? -1 : 0);
+	__m256i near = _mm256_set1_epi32(game.near[TEAM(rank)]);
+	__m256i midX = _mm256_set1_epi32(game.midX);
+	__m256i midY = _mm256_set1_epi32(game.midY);
+	__m256i length = _mm256_set1_epi32(LENGTH);
+	__m256i lane = _mm256_set1_epi32(game.lane);
+	__m256i zone = _mm256_set1_epi32(game.zone);
+	__m256i farZone = _mm256_set1_epi32(LENGTH-game.zone-1);
+	int m;
+
+	for(m = 0; m+8 <= n; m += 8){
+		__m256i bx = _mm256_loadu_si256((const __m256i *)(ballX+m));
+		__m256i by = _mm256_loadu_si256((const __m256i *)(ballY+m));
+		__m256i x = _mm256_loadu_si256((const __m256i *)(posX+m));
+		__m256i y = _mm256_loadu_si256((const __m256i *)(posY+m));
+		__m256i spd = _mm256_loadu_si256((const __m256i *)(speed+m));
+		__m256i dist = _mm256_add_epi32(_mm256_abs_epi32(_mm256_sub_epi32(x, bx)), _mm256_abs_epi32(_mm256_sub_epi32(y, by)));
+		__m256i chase = _mm256_or_si256(chaser, _mm256_cmpgt_epi32(_mm256_mullo_epi32(near, spd), dist));
+		__m256i atBall = _mm256_cmpgt_epi32(dist, spd);		//0 where the player gets to the ball
+
+		//runTowardsBall
+		__m256i tx = x, ty = y;
+		runLanes(bx, by, &tx, &ty, spd);
+		tx = _mm256_blendv_epi8(bx, tx, atBall);
+		ty = _mm256_blendv_epi8(by, ty, atBall);
+
+		//goalPoint: whatever the team and half, that is the basket on the ball's side, unless the player already
+		//stands in front of it
+		__m256i right = _mm256_cmpgt_epi32(bx, midX);
+		__m256i destX = _mm256_and_si256(right, length);
+		__m256i depth = _mm256_blendv_epi8(_mm256_xor_si256(_mm256_cmpgt_epi32(x, zone), _mm256_set1_epi32(-1)), _mm256_cmpgt_epi32(x, farZone), right);
+		__m256i arrived = _mm256_andnot_si256(_mm256_cmpgt_epi32(_mm256_abs_epi32(_mm256_sub_epi32(y, midY)), lane), depth);
+		__m256i gx = x, gy = y;
+		runLanes(destX, midY, &gx, &gy, spd);
+		gx = _mm256_blendv_epi8(gx, x, arrived);
+		gy = _mm256_blendv_epi8(gy, y, arrived);
+
+		_mm256_storeu_si256((__m256i *)(posX+m), _mm256_blendv_epi8(gx, tx, chase));
+		_mm256_storeu_si256((__m256i *)(posY+m), _mm256_blendv_epi8(gy, ty, chase));
+	}
+	return m;
+}
+#endif
+
+//moves player rank in matches 0..n-1 for the round. ballX,ballY are per match, posX,posY,speed are the player's
+//row of the structure of arrays
+void lanesMove(int rank, int round, int n, const int * ballX, const int * ballY, int * posX, int * posY, const int * speed){
+	int from = 0;
+#ifdef LANES_AVX2
+	if(lanesVector())
+		from = moveAvx2(rank, n, ballX, ballY, posX, posY, speed);
+#endif
+	moveScalar(rank, round, from, n, ballX, ballY, posX, posY, speed);
+}
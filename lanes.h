@@ -0,0 +1,11 @@
+#ifndef LANES_H
+#define LANES_H
+
+//runStrategy for one player across many matches at once, on the player-major structure of arrays batch keeps.
+//an avx2 kernel moves 8 matches per step when the cpu has it, otherwise every match goes through runStrategy.
+//both give the same positions
+void lanesMove(int, int, int, const int *, const int *, int *, int *, const int *);
+int lanesVector(void);
+void lanesForceScalar(int);
+
+#endif
@@ -0,0 +1,238 @@
+#include <stdlib.h>
+#include <string.h>
+#include "game.h"
+#include "lanes.h"
+#include "lockstep.h"
+
+void batchInit(struct batch * b, int n){
+	int p, m;
+	b->n = n;
+	b->first = 0;
+	b->seeds = NULL;
+	b->ids = NULL;
+	b->posX = malloc(PLAYERS*n*sizeof(int));
+	b->posY = malloc(PLAYERS*n*sizeof(int));
+	b->target = malloc(PLAYERS*n*sizeof(int));
+	b->speed = malloc(PLAYERS*n*sizeof(int));
+	b->dribbling = malloc(PLAYERS*n*sizeof(int));
+	b->shooting = malloc(PLAYERS*n*sizeof(int));
+	b->challenge = malloc(PLAYERS*n*sizeof(int));
+	b->shotType = malloc(PLAYERS*n*sizeof(int));
+	b->ballX = malloc(n*sizeof(int));
+	b->ballY = malloc(n*sizeof(int));
+	b->score = calloc(2*n, sizeof(int));
+	b->reached = calloc(n, sizeof(int));
+
+	for(p = 0; p < PLAYERS; p++){
+		int playerInfo[PLYR_INFO_SIZE];
+		int speed, dribbling, shooting;
+		initPlayer(p+2, playerInfo, &speed, &dribbling, &shooting);
+		for(m = 0; m < n; m++){
+			int i = p*n + m;
+			b->posX[i] = playerInfo[END_X];
+			b->posY[i] = playerInfo[END_Y];
+			b->target[i] = TEAM(p+2) == 0 ? LENGTH : 0;
+			b->speed[i] = speed;
+			b->dribbling[i] = dribbling;
+			b->shooting[i] = shooting;
+		}
+	}
+	for(m = 0; m < n; m++){
+		b->ballX[m] = LENGTH_HALF;
+		b->ballY[m] = game.midY;
+	}
+}
+
+void batchFree(struct batch * b){
+	free(b->posX);
+	free(b->posY);
+	free(b->target);
+	free(b->speed);
+	free(b->dribbling);
+	free(b->shooting);
+	free(b->challenge);
+	free(b->shotType);
+	free(b->ballX);
+	free(b->ballY);
+	free(b->score);
+	free(b->reached);
+}
+
+//the random stream of process id in match m at round
+static void batchStream(struct batch * b, int m, int round, int id, struct rngStream * rng){
+	if(b->seeds != NULL)
+		rngStart(rng, b->seeds[m], b->ids[m], round, id);
+	else
+		rngStart(rng, b->seed, b->first+m, round, id);
+}
+
+//one round of every match: all players move, then the matches where someone reached the ball resolve the challenge
+void batchRound(struct batch * b, int round){
+	int n = b->n;
+	int p, m;
+	memset(b->reached, 0, n*sizeof(int));
+
+	for(p = 0; p < PLAYERS; p++){
+		lanesMove(p+2, round, n, b->ballX, b->ballY, b->posX+p*n, b->posY+p*n, b->speed+p*n);
+		for(m = 0; m < n; m++)
+			batchChallenge(b, p, m, round);
+	}
+
+	for(m = 0; m < n; m++){
+		if(b->reached[m])
+			batchResolve(b, m, round);
+	}
+}
+
+//the rest of playerTurn once lanesMove has moved player p in match m: only a player on the ball draws
+void batchChallenge(struct batch * b, int p, int m, int round){
+	int i = p*b->n + m;
+	struct rngStream rng;
+	if(round >= HALF_TIME)
+		b->target[i] = TEAM(p+2) == 0 ? 0 : LENGTH;
+	if(b->posX[i] != b->ballX[m] || b->posY[i] != b->ballY[m]){
+		b->challenge[i] = -1;
+		b->shotType[i] = -1;
+		return;
+	}
+	batchStream(b, m, round, p+2, &rng);
+	playerChallenge(p+2, b->posX[i], b->posY[i], b->target[i], b->dribbling[i], b->shooting[i], &b->challenge[i], &b->shotType[i], &rng);
+	b->reached[m]++;
+}
+
+//how many rounds, at most limit, from round on player p of match m only runs towards destX[p],destY[p] without
+//reaching the ball or switching strategy branch, so runRounds can jump over them. chasing[p] is 1 if it runs at
+//the ball, moving[p] 0 if it stands still. a player running to its goal point keeps the round it gets into its
+//zone in zoneAt[p] for as long as zoneGoal[p] says it has been running to the same point, -1 if it has not
+static int eventHorizon(struct batch * b, int p, int m, int round, int limit, int * destX, int * destY, int * chasing, int * moving, int * zoneAt, int * zoneGoal){
+	int i = p*b->n + m;
+	int x = b->posX[i], y = b->posY[i], speed = b->speed[i];
+	int ball[2] = {b->ballX[m], b->ballY[m]};
+	int dist = abs(x - ball[X]) + abs(y - ball[Y]);
+	int radius = game.near[TEAM(p+2)]*speed;
+	int k, near;
+
+	chasing[p] = isChaser(p+2) || dist < radius;
+	moving[p] = 1;
+	if(chasing[p]){
+		//still short of the ball after (dist-1)/speed rounds, and a non chaser only gets nearer
+		zoneGoal[p] = -1;
+		destX[p] = ball[X];
+		destY[p] = ball[Y];
+		k = dist == 0 ? 0 : (dist-1)/speed;
+		return k < limit ? k : limit;
+	}
+	if(goalPoint(p+2, round, ball, x, y, &destX[p], &destY[p])){
+		zoneGoal[p] = -1;
+		moving[p] = 0;
+		return limit;
+	}
+	if(zoneGoal[p] != destX[p]){
+		//first k where the player has arrived in its zone; once in, it stays in. the path only depends on where
+		//it started, so the round stays right while it keeps running there
+		int maxK = (abs(destX[p] - x) + abs(destY[p] - y))/speed;
+		int lo = 1, hi = maxK+1;
+		while(lo < hi){
+			int mid = (lo+hi)/2;
+			int gx, gy;
+			x = b->posX[i];
+			y = b->posY[i];
+			runRounds(destX[p], destY[p], &x, &y, speed, mid);
+			if(goalPoint(p+2, round, ball, x, y, &gx, &gy))
+				hi = mid;
+			else
+				lo = mid+1;
+		}
+		zoneAt[p] = round + (lo < maxK ? lo : maxK);
+		zoneGoal[p] = destX[p];
+	}
+	k = zoneAt[p] - round;
+	//a round changes the distance to the ball by at most speed, so the player cannot come near it sooner
+	near = (dist - radius)/speed + 1;
+	if(near < k)
+		k = near;
+	return k < limit ? k : limit;
+}
+
+//plays match m event by event: stretches of rounds where no player can reach the ball or switch strategy are
+//jumped over with runRounds, and only the rounds in between are played, moving every player one step the way
+//eventHorizon said. returns how many rounds were played
+long long batchFastForward(struct batch * b, int m, int rounds){
+	int n = b->n;
+	int destX[MAX_PLAYERS], destY[MAX_PLAYERS], chasing[MAX_PLAYERS], moving[MAX_PLAYERS];
+	int zoneAt[MAX_PLAYERS], zoneGoal[MAX_PLAYERS];
+	int round = 0;
+	int p, k;
+	long long played = 0;
+
+	for(p = 0; p < PLAYERS; p++)
+		zoneGoal[p] = -1;
+	while(round < rounds){
+		k = rounds - round;
+		if(round < HALF_TIME && HALF_TIME - round < k)
+			k = HALF_TIME - round;		//targets turn around at half time
+		for(p = 0; p < PLAYERS; p++){		//every player, so zoneGoal follows each one from call to call
+			int safe = eventHorizon(b, p, m, round, k, destX, destY, chasing, moving, zoneAt, zoneGoal);
+			if(safe < k)
+				k = safe;
+		}
+
+		if(k == 0){
+			b->reached[m] = 0;
+			for(p = 0; p < PLAYERS; p++){
+				int i = p*n + m;
+				if(chasing[p] && abs(b->posX[i] - destX[p]) + abs(b->posY[i] - destY[p]) <= b->speed[i]){
+					b->posX[i] = destX[p];
+					b->posY[i] = destY[p];
+				}
+				else if(moving[p])
+					run(destX[p], destY[p], &b->posX[i], &b->posY[i], b->speed[i]);
+				batchChallenge(b, p, m, round);
+			}
+			if(b->reached[m])
+				batchResolve(b, m, round);
+			round++;
+			played++;
+			continue;
+		}
+
+		for(p = 0; p < PLAYERS; p++){
+			int i = p*n + m;
+			if(moving[p])
+				runRounds(destX[p], destY[p], &b->posX[i], &b->posY[i], b->speed[i], k);
+			if(round >= HALF_TIME)
+				b->target[i] = TEAM(p+2) == 0 ? 0 : LENGTH;
+		}
+		round += k;
+	}
+	return played;
+}
+
+//field process work for one match: rebuild the player messages it would have received and resolve the challenge
+void batchResolve(struct batch * b, int m, int round){
+	int n = b->n;
+	int playerMessage[MAX_PROCESSES*PLYR_MSG_SIZE];
+	int ballCoords[2] = {b->ballX[m], b->ballY[m]};
+	int ballChallengeInfo[7];
+	struct rngStream rng;
+	int p;
+
+	for(p = 0; p < PLAYERS; p++){
+		int i = p*n + m;
+		int * currPlayer = playerMessage+((p+2)*PLYR_MSG_SIZE);
+		*(currPlayer+X) = b->posX[i];
+		*(currPlayer+Y) = b->posY[i];
+		*(currPlayer+RANK) = p+2;
+		*(currPlayer+CHAL_SCR) = b->challenge[i];
+		*(currPlayer+SHOT_TYPE) = b->shotType[i];
+		*(currPlayer+SHOOT_SKILL) = b->shooting[i];
+		*(currPlayer+RND_NO) = round;
+	}
+
+	batchStream(b, m, round, FP0, &rng);
+	resolveBallChallenge(round, playerMessage, ballCoords, ballChallengeInfo, &rng);
+	if(ballChallengeInfo[0] > 0)
+		b->score[m*2 + ballChallengeInfo[6]] += ballChallengeInfo[5];
+	b->ballX[m] = ballChallengeInfo[3];
+	b->ballY[m] = ballChallengeInfo[4];
+}
@@ -0,0 +1,35 @@
+#ifndef LOCKSTEP_H
+#define LOCKSTEP_H
+
+#include "game.h"
+
+//n independent matches played in lockstep on one core, stored as structure of arrays.
+//per-player arrays are player-major: entry [p*n + m] is player p (rank p+2) of match m
+struct batch{
+	int n;
+	unsigned int seed;
+	int first;		//match m draws the streams of match id first+m
+	unsigned int * seeds;		//if set, match m draws the streams of seeds[m] and match id ids[m] instead
+	int * ids;
+	int * posX;
+	int * posY;
+	int * target;
+	int * speed;
+	int * dribbling;
+	int * shooting;
+	int * challenge;	//challenge score this round, -1 if the player did not reach the ball
+	int * shotType;
+	int * ballX;
+	int * ballY;
+	int * score;		//[m*2 + team]
+	int * reached;		//players that reached the ball in match m this round
+};
+
+void batchInit(struct batch *, int);
+void batchFree(struct batch *);
+void batchRound(struct batch *, int);
+void batchChallenge(struct batch *, int, int, int);
+void batchResolve(struct batch *, int, int);
+long long batchFastForward(struct batch *, int, int);
+
+#endif
@@ -2,641 +2,1507 @@
 #include <stdio.h>
 #include <time.h>
 #include <stdlib.h>
-#include <math.h>
-
-#define PROCESSES 12
-#define PLAYERS 10
-
-#define LENGTH 128
-#define WIDTH 64
-#define LENGTH_HALF 64
-#define SHOOT_THRES 10
-
-#define FP0 0
-#define FP1 1
-
-#define X 0
-#define Y 1
-
-#define SCORE 0
-#define PASS 1
-
-#define PLYR_MSG_SIZE 7
-#define RANK 2
-#define CHAL_SCR 3
-#define SHOT_TYPE 4
-#define SHOOT_SKILL 5
-#define RND_NO 6
-
-#define PLYR_INFO_SIZE 9
-#define INIT_X 0
-#define INIT_Y 1
-#define END_X 2
-#define END_Y 3
-#define REACH_RND 4
-#define WIN_RND 5
-#define CHALLENGE 6
-#define SHOOT_X 7
-#define SHOOT_Y 8
-
-void initInfo(int *);
-int nearBall(int *, int *, int);
-void runStrategy(int, int, int*, int*, int*, int);
-int runTowardsBall(int, int, int, int, int*, int*, int);
-void run(int, int, int*, int*, int);
-void runOffenseDirection(int, int, int, int, int *, int *, int);
-void runDefenseDirection(int, int, int, int, int *, int *, int);
-void determineShot(int, int *, int *, int *);
-float getShotProbability(int, int);
-int inMyField(int *);
-int fieldProcess(int *);
-int isOffenseSide(int, int*, int);
-
-long long wall_clock_time()
-{
-#ifdef __linux__
-	struct timespec tp;
-	clock_gettime(CLOCK_REALTIME, &tp);
-	return (long long)(tp.tv_nsec + (long long)tp.tv_sec * 1000000000ll);
-#else
-#warning "Your timer resolution might be too low. Compile on Linux and link with librt"
-	struct timeval tv;
-	gettimeofday(&tv, NULL);
-	return (long long)(tv.tv_usec * 1000 + (long long)tv.tv_sec * 1000000000ll);
-#endif
-}
+#include <string.h>
+#include <stddef.h>
+#include <sys/resource.h>
+#include "game.h"
+#include "trace.h"
+#include "writer.h"
+#include "probe.h"
+#include "host.h"
+#include "stats.h"
+#include "checkpoint.h"
+#include "place.h"
+#include "telemetry.h"
+
+//tags
+#define BALL_TAG 1
+#define BALL_CHALLENGE_TAG 2
+#define INFO_TAG 4
+#define MESSAGE_TAG 8
+#define SPEC_FIX_TAG 16		//--speculate: a player's move redone for the real ball
+
+//round communication modes
+#define COMM_P2P 0
+#define COMM_COLL 1
+#define COMM_PERSIST 2
+#define COMM_SHM 3		//one shared-memory window on the node, puts into per-rank windows otherwise
+#define COMM_RMA 4		//always puts into per-rank windows
+
+struct options{
+	int comm;
+	int rounds;
+	int output;
+	char * tracePath;
+	int async;
+	int timing;
+	int profile;
+	int tileCols;		//--tiles: grid of field process tiles, 0 for the fp0/fp1 split
+	int tileRows;
+	int seedSet;
+	unsigned int seed;
+	char * replayPath;	//--replay: binary trace to check this run against, round by round
+	int ensemble;		//--ensemble: split the job into independent matches of fieldCount+PLAYERS ranks
+	int threads;		//--threads: players per rank, hosted as threads. 0 for a rank per player
+	int stats;
+	int checkpointEvery;	//--checkpoint: rounds between checkpoints, 0 for none
+	char * checkpointPath;
+	char * restartPath;	//--restart: checkpoint to resume from
+	char * rosterPath;	//--roster: court, match length and players, read by rank 0
+	int replicate;		//--replicate: both field processes get every real message and resolve the challenge
+	int checkReplicas;	//--check-replicas: fp1 sends its result to fp0 to compare, every round
+	int reorder;		//--reorder: renumber the match's ranks for locality before roles are handed out
+	char * telemetryName;	//--telemetry: shared memory fp0 publishes a sample per round to, NULL for none
+	int speculate;		//--speculate: players move for the next round before its ball arrives
+};
+
+//persistent requests for the fixed per-round pattern (--comm persist)
+struct persistentReqs{
+	MPI_Request ball[MAX_PROCESSES];		//fp0: send to each player. players: ball[0] receives from fp0
+	MPI_Request msg[MAX_PROCESSES];		//field processes: receive from each player. players: msg[FP0], msg[FP1]
+	MPI_Request info[MAX_PROCESSES];		//fp0: receive from each player. players: info[0] sends to fp0
+	MPI_Request challengeSend;
+	MPI_Request challengeRecv;
+	int challengeStarted;
+	int fpMessage[2][PLYR_MSG_SIZE];	//players: what goes to fp0 and fp1, real or dummy
+};
+
+//what players and the ball owner write each round under --comm shm|rma
+struct rmaBoard{
+	int playerMessage[MAX_PROCESSES*PLYR_MSG_SIZE];	//read by the ball owner
+	int playerInfo[MAX_PROCESSES*PLYR_INFO_SIZE];	//read by fp0
+	int ballChallengeInfo[7];			//read by everyone
+};
+
+struct rmaState{
+	MPI_Win win;
+	int shared;		//one board in shared memory that every rank loads and stores directly
+	struct rmaBoard * board;	//the shared board, or this rank's own window
+	int * ownMessages;	//field processes: their playerMessage buffer while the board stands in for it
+};
+
+//--speculate: once a player's round is done it moves for the next one as if the ball stays where it is, and sends
+//that move straight away. the field processes know the guess too, so when the ball has moved they throw those
+//messages away and wait for the moves redone for the real ball
+struct speculation{
+	int pending;		//the next round's messages went out during this one
+	int ball[2];		//the ball they were moved for: where it was when this round started
+	//players
+	int info[PLYR_INFO_SIZE];		//the move, kept apart from the player's state until the ball confirms it
+	int target;
+	int message[PLYR_MSG_SIZE];
+	int dummy[PLYR_MSG_SIZE];
+	MPI_Request sends[2];
+	long long moveNs;		//the pending move took
+	long long usedNs;		//moves that stood, made while the field processes were still busy
+	long long redoneNs;		//moves thrown away
+	//field processes
+	int stale[MAX_PROCESSES*PLYR_MSG_SIZE];		//the messages of a wrong guess
+	int hits;		//fp0
+	int misses;
+	long long hitWaitNs;		//fp0 waiting for the player messages, in rounds the guess was right
+	long long missWaitNs;
+};
+
+//everything a rank carries from one round to the next
+struct matchState{
+	MPI_Comm comm;		//the ranks playing this match, MPI_COMM_WORLD unless --ensemble
+	int rank;		//rank in comm
+	int id;			//player id 2..11 the game rules know the player by, or the field process number
+	int round;
+	unsigned int seed;
+	int match;		//match id the random streams are keyed by, the group number under --ensemble
+	int fieldCount;		//field processes take ranks 0..fieldCount-1, players the ranks after them
+	int tileCols;
+	int tileRows;
+	int hosted;		//players per player rank under --threads, 0 otherwise
+	int replicate;
+	int rounds;		//the match is played to
+	int speculate;
+	struct speculation spec;
+	//field processes
+	int ballCoords[2];
+	int * playerMessage;
+	int allPlayerInfo[MAX_PROCESSES*PLYR_INFO_SIZE];
+	int score[2];
+	int ballChallengeInfo[7];
+	//player processes
+	int playerInfo[PLYR_INFO_SIZE];
+	int target;
+	int speed;
+	int dribbling;
+	int shooting;
+	struct persistentReqs persist;
+	struct rmaState rma;
+	struct playerHost host;		//--threads
+	//fp0 output
+	int output;
+	int needInfo;		//players send their info to fp0 every round, not under --output score
+	struct traceRound record;
+	struct traceWriter trace;
+	int async;
+	struct roundWriter writer;
+	//fp0 --replay
+	int replaying;
+	struct traceReader replay;
+	int replayDiff;		//first round that differs from the recorded trace, -1 while they agree
+	//fp0 --check-replicas
+	int checkReplicas;
+	int replicaDiff;	//first round fp1 resolved differently, -1 while they agree
+	int replicaDiffs;
+	struct probe prof;
+	struct matchStats stats;
+	//--checkpoint
+	struct checkpointFile checkpoint;
+	int checkpoints;
+	long long checkpointNs;
+	long long checkpointMaxNs;
+	//fp0 --telemetry
+	int telemetering;
+	struct telemetry telemetry;
+};
+
+int parseOptions(int, char **, struct options *);
+void p2pRound(struct matchState *);
+void collectiveRound(struct matchState *);
+void persistentSetup(struct matchState *);
+void persistentRound(struct matchState *);
+void persistentTeardown(struct matchState *);
+void rmaSetup(struct matchState *, int);
+void rmaRound(struct matchState *);
+void rmaTeardown(struct matchState *);
+void tiledRound(struct matchState *);
+void hostedRound(struct matchState *);
+int playerMove(struct matchState *);
+void p2pSend(struct matchState *, int *, int *, int, int, MPI_Request *);
+void specMove(struct matchState *);
+void specCommit(struct matchState *);
+void specReport(struct matchState *, FILE *);
+void resolveChallenge(struct matchState *);
+void applyBallChallenge(struct matchState *);
+void outputRoundStart(struct matchState *);
+void outputRoundEnd(struct matchState *);
+void replayCheck(struct matchState *);
+void replicaCheck(struct matchState *, MPI_Request *);
+void reportPeakRss(MPI_Comm);
+void ensembleReport(struct matchState *, int);
+void checkpointSave(struct matchState *);
+void checkpointRestore(struct matchState *, struct ckptHeader *, struct ckptPlayer *);
 
 int main(int argc, char *argv[]){
 	int rank, numtasks;
-	MPI_Init(&argc,&argv);
+	int provided;
+	MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);		//fp0's writer thread and hosted player threads never call MPI
 	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
 	MPI_Comm_size(MPI_COMM_WORLD, &numtasks);
-	if(numtasks != PROCESSES){
-		printf("warning: 12 processes are required. exiting..\n");
+	struct options opts;
+	if(parseOptions(argc, argv, &opts)){
+		if(rank == FP0)
+			printf("usage: match [--comm p2p|coll|persist|shm|rma] [--tiles colsxrows] [--rounds n] [--output text|binary|none|score] [--trace file] [--async] [--timing] [--profile] [--seed n] [--replay file] [--ensemble] [--threads n] [--stats] [--checkpoint n] [--checkpoint-file file] [--restart file] [--roster file] [--replicate] [--check-replicas] [--reorder] [--telemetry name] [--speculate]\n");
 		MPI_Finalize();
 		exit(0);
 	}
-	srand(time(NULL)+rank);
-	
-	MPI_Request reqs[PROCESSES];
-	MPI_Status stat[PROCESSES];
-	int target;
-	target = rank < 7 ? 128 : 0;
+	int rosterLine = rank == FP0 && opts.rosterPath != NULL ? gameLoadRoster(opts.rosterPath) : 0;
+	MPI_Bcast(&rosterLine, 1, MPI_INT, FP0, MPI_COMM_WORLD);
+	if(rosterLine){
+		if(rank == FP0)
+			printf("cannot load roster %s (line %d). exiting..\n", opts.rosterPath, rosterLine);
+		MPI_Finalize();
+		exit(0);
+	}
+	MPI_Bcast(&game, sizeof(game), MPI_BYTE, FP0, MPI_COMM_WORLD);		//every rank plays the roster rank 0 read
+	if(opts.rounds == 0)
+		opts.rounds = ROUNDS;
+	if(PLAYERS % (opts.threads ? opts.threads : 1) != 0){
+		if(rank == FP0)
+			printf("warning: --threads must divide the %d players. exiting..\n", PLAYERS);
+		MPI_Finalize();
+		exit(0);
+	}
+	int fieldCount = opts.tileCols ? opts.tileCols*opts.tileRows : 2;
+	int perRank = opts.threads ? opts.threads : 1;		//players on each player rank
+	int groupSize = fieldCount + PLAYERS/perRank;
+	if(opts.ensemble ? numtasks % groupSize != 0 : numtasks != groupSize){
+		if(rank == FP0){
+			if(opts.ensemble)
+				printf("warning: --ensemble needs a multiple of %d processes. exiting..\n", groupSize);
+			else
+				printf("warning: %d processes are required. exiting..\n", groupSize);
+		}
+		MPI_Finalize();
+		exit(0);
+	}
+	int worldRank = rank;
+	int matches = numtasks / groupSize;
+	if(opts.ensemble && opts.output == OUTPUT_TEXT)
+		opts.output = OUTPUT_NONE;		//interleaved text traces of many matches are of no use
 	
+	struct matchState state;
+	struct matchState * s = &state;
+	MPI_Comm_split(MPI_COMM_WORLD, worldRank / groupSize, worldRank, &s->comm);
+	struct placement placement;
+	if(opts.reorder){
+		MPI_Comm placed;
+		placeRanks(s->comm, fieldCount, perRank, &placed, &placement);
+		MPI_Comm_free(&s->comm);
+		s->comm = placed;
+	}
+	MPI_Comm_rank(s->comm, &rank);
+	s->rank = rank;
+	int firstId = rank < fieldCount ? 0 : (rank - fieldCount)*perRank + 2;
+	int ownPlayers = rank < fieldCount ? 0 : perRank;
+	struct ckptHeader restart;
+	struct ckptPlayer restartPlayers[MAX_PLAYERS];
+	char checkpointPath[4096], restartPath[4096];
+	if(opts.ensemble){		//one checkpoint per match
+		snprintf(checkpointPath, sizeof(checkpointPath), "%s.%d", opts.checkpointPath, worldRank / groupSize);
+		snprintf(restartPath, sizeof(restartPath), "%s.%d", opts.restartPath ? opts.restartPath : "", worldRank / groupSize);
+	}
+	else{
+		snprintf(checkpointPath, sizeof(checkpointPath), "%s", opts.checkpointPath);
+		snprintf(restartPath, sizeof(restartPath), "%s", opts.restartPath ? opts.restartPath : "");
+	}
+	if(opts.restartPath != NULL){
+		if(checkpointRead(s->comm, restartPath, &restart, restartPlayers, firstId, ownPlayers)){
+			if(rank == FP0)
+				printf("cannot restart from %s. exiting..\n", restartPath);
+			MPI_Abort(MPI_COMM_WORLD, 1);
+		}
+		if(!opts.seedSet){		//a different --seed plays a what-if branch from the checkpoint
+			opts.seed = restart.seed;
+			opts.seedSet = 1;
+		}
+	}
+	s->replaying = rank == FP0 && opts.replayPath != NULL;
+	s->replayDiff = -1;
+	if(s->replaying){
+		if(traceReadOpen(&s->replay, opts.replayPath) || s->replay.players != PLAYERS || s->replay.teamSize != game.teamSize){
+			printf("cannot read trace %s. exiting..\n", opts.replayPath);
+			MPI_Abort(MPI_COMM_WORLD, 1);
+		}
+		if(!opts.seedSet)
+			opts.seed = s->replay.seed;
+	}
+	else if(!opts.seedSet)
+		opts.seed = (unsigned int)time(NULL);
+	MPI_Bcast(&opts.seed, 1, MPI_UNSIGNED, FP0, MPI_COMM_WORLD);		//one seed for every rank
+	if(opts.reorder)		//fp0 may no longer be world rank 0, and it read the seed of a --replay
+		MPI_Bcast(&opts.seed, 1, MPI_UNSIGNED, FP0, s->comm);
+	s->seed = opts.seed;
+	s->match = opts.restartPath ? restart.match : worldRank / groupSize;
+	s->telemetering = rank == FP0 && opts.telemetryName != NULL;
+	probeInit(&s->prof, opts.profile || s->telemetering);		//the samples carry fp0's wait time
+	statsInit(&s->stats, opts.stats);
+	s->fieldCount = fieldCount;
+	s->id = rank < fieldCount ? rank : firstId;		//first hosted player under --threads
+	s->tileCols = opts.tileCols;
+	s->tileRows = opts.tileRows;
+	s->hosted = opts.threads;
+	s->replicate = opts.replicate;
+	s->checkReplicas = opts.checkReplicas;
+	s->replicaDiff = -1;
+	s->replicaDiffs = 0;
+	s->rounds = opts.rounds;
+	s->speculate = opts.speculate;
+	memset(&s->spec, 0, sizeof(s->spec));
+	s->spec.sends[0] = s->spec.sends[1] = MPI_REQUEST_NULL;
+	if(s->hosted && rank >= fieldCount && hostStart(&s->host, s->id, s->hosted, s->seed, s->match)){
+		printf("cannot start player threads. exiting..\n");
+		MPI_Abort(MPI_COMM_WORLD, 1);
+	}
+	s->output = opts.output;
+	s->needInfo = opts.output != OUTPUT_SCORE;
+	char tracePath[4096];
+	if(opts.ensemble)
+		snprintf(tracePath, sizeof(tracePath), "%s.%d", opts.tracePath, s->match);		//one trace per match
+	else
+		snprintf(tracePath, sizeof(tracePath), "%s", opts.tracePath);
+	if(rank == FP0 && opts.output == OUTPUT_BINARY && traceOpen(&s->trace, tracePath, s->seed)){
+		printf("cannot write trace %s. exiting..\n", tracePath);
+		MPI_Abort(MPI_COMM_WORLD, 1);
+	}
+	s->async = rank == FP0 && opts.async;
+	if(s->async && writerStart(&s->writer, opts.output, &s->trace)){
+		printf("cannot start writer thread. exiting..\n");
+		MPI_Abort(MPI_COMM_WORLD, 1);
+	}
+	char telemetryName[TELEM_NAME];
+	if(opts.ensemble)
+		snprintf(telemetryName, sizeof(telemetryName), "%s.%d", opts.telemetryName, s->match);		//one ring per match
+	else
+		snprintf(telemetryName, sizeof(telemetryName), "%s", opts.telemetryName);
+	if(s->telemetering && telemetryOpen(&s->telemetry, telemetryName, s->match, s->seed, opts.rounds)){
+		printf("cannot publish telemetry to %s. exiting..\n", telemetryName);
+		MPI_Abort(MPI_COMM_WORLD, 1);
+	}
+	s->target = TEAM(s->id) == 0 ? LENGTH : 0;
 	
 	//field processes
-	int ballCoords[2];
-	ballCoords[0] = LENGTH_HALF;
-	ballCoords[1] = 32;		
-	int * playerMessage;
-	if(rank == FP0 || rank == FP1)
-		playerMessage = malloc(PROCESSES*PLYR_MSG_SIZE*sizeof(int));
+	s->ballCoords[0] = LENGTH_HALF;
+	s->ballCoords[1] = game.midY;
+	if(rank < fieldCount)
+		s->playerMessage = malloc(PROCESSES*PLYR_MSG_SIZE*sizeof(int));
 	else
-		playerMessage = malloc(PLYR_MSG_SIZE*sizeof(int));
-	int allPlayerInfo[PROCESSES*PLYR_INFO_SIZE];
-	int score[2] = {0};
-	int ballChallengeInfo[7];
-	MPI_Status recvMsgStatus[PLAYERS];
-	MPI_Request sendBallCoordsReqs[PROCESSES];
-	MPI_Request recvMsg[PLAYERS];
+		s->playerMessage = malloc(PLYR_MSG_SIZE*sizeof(int));
+	s->score[0] = s->score[1] = 0;
 	
 	//player processes
-	MPI_Request messages[2];
-	MPI_Request ballRequest[2];
-	MPI_Status ballRequestStatus[2];
-	int playerInfo [PLYR_INFO_SIZE];
-	int speed = 5;
-	int dribbling = 5;
-	int shooting = 5;
-	switch(rank){
-		case 2:
-			playerInfo[INIT_X] = playerInfo[END_X] = 21; 
-			playerInfo[INIT_Y] = playerInfo[END_Y] = 48; 
-			speed = 3; dribbling = 10; shooting = 2;
-			break;
-		case 3:
-			playerInfo[INIT_X] = playerInfo[END_X] = 21; 
-			playerInfo[INIT_Y] = playerInfo[END_Y] = 32; 
-			speed = 3; dribbling = 8; shooting = 4;
-			break;
-		case 4:
-			playerInfo[INIT_X] = playerInfo[END_X] = 21; 
-			playerInfo[INIT_Y] = playerInfo[END_Y] = 16; 
-			speed = 5; dribbling = 7; shooting = 3;
-			break;
-		case 5:
-			playerInfo[INIT_X] = playerInfo[END_X] = 41; 
-			playerInfo[INIT_Y] = playerInfo[END_Y] = 48; 
-			speed = 10; dribbling = 3; shooting = 2;
-			break;
-		case 6:
-			playerInfo[INIT_X] = playerInfo[END_X] = 41; 
-			playerInfo[INIT_Y] = playerInfo[END_Y] = 16; 
-			speed = 8; dribbling = 1; shooting = 6;
-			break;
-		case 7:
-			playerInfo[INIT_X] = playerInfo[END_X] = 107; 
-			playerInfo[INIT_Y] = playerInfo[END_Y] = 48; 
-			speed = 7; dribbling = 2; shooting = 6;
-			break;
-		case 8:
-			playerInfo[INIT_X] = playerInfo[END_X] = 107; 
-			playerInfo[INIT_Y] = playerInfo[END_Y] = 32; 
-			speed = 10; dribbling = 4; shooting = 1;
-			break;
-		case 9:
-			playerInfo[INIT_X] = playerInfo[END_X] = 107; 
-			playerInfo[INIT_Y] = playerInfo[END_Y] = 16; 
-			speed = 3; dribbling = 10; shooting = 2;
-			break;
-		case 10:
-			playerInfo[INIT_X] = playerInfo[END_X] = 87; 
-			playerInfo[INIT_Y] = playerInfo[END_Y] = 48; 
-			speed = 8; dribbling = 2; shooting = 5;
-			break;
-		case 11:
-			playerInfo[INIT_X] = playerInfo[END_X] = 87; 
-			playerInfo[INIT_Y] = playerInfo[END_Y] = 16; 
-			speed = 5; dribbling = 2; shooting = 8;
-			break;
-	}
-	playerInfo[REACH_RND] = playerInfo[WIN_RND] = 0;
-	playerInfo[CHALLENGE] = playerInfo[SHOOT_X] = playerInfo[SHOOT_Y] = -1;
-	
-	//tags
-	int ballTag = 1;
-	int ballChallengeTag = 2;
-	int infoTag = 4;
-	int messageTag = 8;
-
-	//set playerMessage for fp0 and fp1
-	if(rank == FP0 || rank == FP1){
+	initPlayer(s->id, s->playerInfo, &s->speed, &s->dribbling, &s->shooting);
+
+	//set playerMessage for the field processes
+	if(rank < fieldCount){
 		int i;
 		for(i = 2; i < PROCESSES; i++){
-			*(playerMessage+((i*PLYR_MSG_SIZE)+RND_NO)) = 1;
+			*(s->playerMessage+((i*PLYR_MSG_SIZE)+RND_NO)) = 1;
 		}
 	}
+	int firstRound = 0;
+	if(opts.restartPath != NULL){
+		checkpointRestore(s, &restart, restartPlayers);
+		firstRound = restart.round;
+	}
+	s->checkpoints = 0;
+	s->checkpointNs = s->checkpointMaxNs = 0;
+	if(opts.checkpointEvery && checkpointOpen(&s->checkpoint, s->comm, checkpointPath)){
+		if(rank == FP0)
+			printf("cannot write checkpoint %s. exiting..\n", checkpointPath);
+		MPI_Abort(MPI_COMM_WORLD, 1);
+	}
+	if(opts.checkpointEvery && opts.restartPath != NULL){		//the file may be the one restarted from, which was just emptied
+		s->round = firstRound-1;
+		checkpointSave(s);
+	}
 	
 	//ROUND
-	int round;
-	long before, after;
+	long long before = 0, after = 0;
+	if(opts.ensemble)
+		MPI_Barrier(MPI_COMM_WORLD);
 	if(rank == FP0)
 		before = wall_clock_time();
-	for(round = 0; round < 5400; round++){
-		/****************************************************
-		*****PLAYERS
-		***************************************************/
-		if(rank != FP0 && rank != FP1){
-			initInfo(playerInfo);			//init all variables
-			if(round >= 2700){
-				target = rank < 7 ? 0 : 128;
-			}
-			
-			//Get ball coordinates
-			int ballSender;
-			if(round != 0){
-				MPI_Irecv(ballCoords, 2, MPI_INT, FP0, ballTag, MPI_COMM_WORLD, &ballRequest[0]);
-				MPI_Irecv(ballCoords, 2, MPI_INT, FP1, MPI_ANY_TAG, MPI_COMM_WORLD, &ballRequest[1]);
-				MPI_Waitany(2, ballRequest, &ballSender, ballRequestStatus);
-			}
-			
-			//Apply run strategy
-			runStrategy(rank, round, ballCoords, playerInfo, playerInfo+2, speed);
-			
-			//if reach ball send message with all fields set
-			if(playerInfo[END_X] == ballCoords[X] && playerInfo[END_Y] == ballCoords[Y]){
-				playerMessage[X] = playerInfo[END_X];
-				playerMessage[Y] = playerInfo[END_Y];
-				playerMessage[RANK] = rank;
-				playerMessage[CHAL_SCR] = (rand() % 10 + 1) * dribbling;
-				
-				int dist = abs(playerInfo[END_X] - target) + abs(playerInfo[END_Y] - 32);
-				//we determine what the shot type is (either we try to score, or we pass)
-				if(getShotProbability(dist, shooting) > 0.6)
-					playerMessage[SHOT_TYPE] = SCORE;
-				else
-					playerMessage[SHOT_TYPE] = PASS;
-					
-				playerMessage[SHOOT_SKILL] = shooting;
-				playerMessage[RND_NO] = round;
-				
-				//send our message: 1 to our corresopnding field process, and 1 to the other field process as dummy
-				int fp = fieldProcess(ballCoords);
-				MPI_Isend(playerMessage, PLYR_MSG_SIZE, MPI_INT, fp, messageTag, MPI_COMM_WORLD, &messages[0]);
-				playerMessage[X] = -1;	//set message as dummy
-				if(fp == FP0)
-					MPI_Isend(playerMessage, PLYR_MSG_SIZE, MPI_INT, FP1, messageTag, MPI_COMM_WORLD, &messages[1]);
-				else
-					MPI_Isend(playerMessage, PLYR_MSG_SIZE, MPI_INT, FP0, messageTag, MPI_COMM_WORLD, &messages[1]);
-					
-				//set my own player information
-				playerInfo[REACH_RND] = 1;
-				playerInfo[CHALLENGE] = playerMessage[CHAL_SCR];
-			}
-			else{		//i did not reach the ball this round
-				//set information for sending
-				playerMessage[X] = playerInfo[END_X];
-				playerMessage[Y] = playerInfo[END_Y];
-				playerMessage[RANK] = rank;
-				playerMessage[CHAL_SCR] = -1;
-				playerMessage[SHOT_TYPE] = -1;
-				playerMessage[SHOOT_SKILL] = shooting;
-				playerMessage[RND_NO] = round;
-
-				//send our message: 1 to our corresopnding field process, and 1 to the other field process as dummy
-				int fp = fieldProcess(ballCoords);
-				MPI_Isend(playerMessage, PLYR_MSG_SIZE, MPI_INT, fp, messageTag, MPI_COMM_WORLD, &messages[0]);
-				if(fp == FP0)
-					MPI_Isend(playerMessage, PLYR_MSG_SIZE, MPI_INT, FP1, messageTag, MPI_COMM_WORLD, &messages[1]);
-				else
-					MPI_Isend(playerMessage, PLYR_MSG_SIZE, MPI_INT, FP0, messageTag, MPI_COMM_WORLD, &messages[1]);
-			}
-			//round finish, send all info for printing
-			MPI_Isend(playerInfo, PLYR_INFO_SIZE, MPI_INT, FP0, infoTag, MPI_COMM_WORLD, &reqs[rank]);
-		}/************************************END OF PLAYER PROCESS***************************************/
-		else{	
-			/****************************************************************************
-			****FIELD PROCESSES
-			****************************************************************************/
-			int i;
-			if(rank == FP0){
-				printf("%d\n%d %d\n%d %d\n", round, score[0], score[1], ballCoords[X], ballCoords[Y]);
-			}
+	if(opts.comm == COMM_PERSIST)
+		persistentSetup(s);
+	if((opts.comm == COMM_SHM || opts.comm == COMM_RMA) && !opts.tileCols)
+		rmaSetup(s, opts.comm == COMM_SHM);
+	for(s->round = firstRound; s->round < opts.rounds; s->round++){
+		probeRound(&s->prof);
+		long long t = probeStart(&s->prof);
+		if(opts.threads)
+			hostedRound(s);
+		else if(opts.tileCols)
+			tiledRound(s);
+		else if(opts.comm == COMM_COLL)
+			collectiveRound(s);
+		else if(opts.comm == COMM_PERSIST)
+			persistentRound(s);
+		else if(opts.comm == COMM_SHM || opts.comm == COMM_RMA)
+			rmaRound(s);
+		else
+			p2pRound(s);
+		probeEnd(&s->prof, PHASE_ROUND, t);
+		if(s->telemetering)
+			telemetryPublish(&s->telemetry, s->round, s->score, s->ballCoords, probeWaitNs(&s->prof));
+		if(opts.checkpointEvery && (s->round+1) % opts.checkpointEvery == 0)
+			checkpointSave(s);
+	}
+	if(opts.checkpointEvery && checkpointClose(&s->checkpoint)){
+		printf("cannot write checkpoint. exiting..\n");
+		MPI_Abort(MPI_COMM_WORLD, 1);
+	}
+	if(opts.comm == COMM_PERSIST)
+		persistentTeardown(s);
+	if((opts.comm == COMM_SHM || opts.comm == COMM_RMA) && !opts.tileCols)
+		rmaTeardown(s);
+	if(s->hosted && rank >= fieldCount)
+		hostStop(&s->host);
+	long long elapsed = 0;
+	if(rank == FP0){
+		after = wall_clock_time();
+		elapsed = after - before;
+		if(opts.timing && !opts.ensemble)
+			fprintf(stderr, "%d ranks, %d rounds in %1.5f sec, %1.2f usec/round\n", numtasks, opts.rounds - firstRound,
+				(float)elapsed/1000000000, (float)elapsed/1000/(opts.rounds - firstRound));
+		if(opts.timing && opts.reorder && !opts.ensemble)
+			placeReport(&placement, stderr);
+		if(opts.timing && s->telemetering && !opts.ensemble)
+			telemetryReport(&s->telemetry, stderr);
+		if(opts.timing && s->checkpoints)
+			fprintf(stderr, "%d checkpoints, %1.2f usec mean, %1.2f usec max\n", s->checkpoints,
+				(float)s->checkpointNs/1000/s->checkpoints, (float)s->checkpointMaxNs/1000);
+	}
+	if(opts.ensemble){
+		long long slowest;
+		MPI_Reduce(&elapsed, &slowest, 1, MPI_LONG_LONG, MPI_MAX, 0, MPI_COMM_WORLD);
+		if(opts.timing && worldRank == 0)
+			fprintf(stderr, "%d matches on %d ranks, %d rounds in %1.5f sec, %1.1f matches/sec\n", matches, numtasks, opts.rounds,
+				(float)slowest/1000000000, matches/((double)slowest/1000000000));
+		ensembleReport(s, worldRank);
+	}
+	if(opts.timing)
+		reportPeakRss(MPI_COMM_WORLD);
+	if(opts.profile)
+		probeReport(&s->prof, MPI_COMM_WORLD, FP0, stderr);
+	if(opts.speculate && !opts.ensemble)
+		specReport(s, stderr);
+	if(s->async){
+		writerStop(&s->writer);
+		writerReport(&s->writer, stderr);
+	}
+	if(rank == FP0 && opts.output == OUTPUT_BINARY && traceClose(&s->trace)){
+		printf("cannot write trace %s. exiting..\n", tracePath);
+		MPI_Abort(MPI_COMM_WORLD, 1);
+	}
+	if(s->telemetering)
+		telemetryClose(&s->telemetry);
+	if(rank == FP0 && opts.output == OUTPUT_SCORE && !opts.ensemble)
+		printf("%d %d %d\n", s->match, s->score[0], s->score[1]);
+	statsReport(&s->stats, MPI_COMM_WORLD, FP0, stdout);
+	int replayFailed = 0;
+	if(s->replaying){
+		struct traceRound extra;
+		if(s->replayDiff < 0 && traceNext(&s->replay, &extra))
+			s->replayDiff = opts.rounds;		//the recorded match went on longer
+		if(s->replayDiff < 0)
+			fprintf(stderr, "replay: seed %u, %d rounds identical to %s\n", s->seed, opts.rounds, opts.replayPath);
+		else
+			fprintf(stderr, "replay: seed %u, differs from %s at round %d\n", s->seed, opts.replayPath, s->replayDiff);
+		replayFailed = s->replayDiff >= 0;
+		traceReadClose(&s->replay);
+	}
+	if(rank == FP0 && s->checkReplicas){
+		if(s->replicaDiffs == 0)
+			fprintf(stderr, "replicas: %d rounds resolved identically by fp0 and fp1\n", opts.rounds - firstRound);
+		else
+			fprintf(stderr, "replicas: fp0 and fp1 differ in %d rounds, first at round %d\n", s->replicaDiffs, s->replicaDiff);
+		replayFailed |= s->replicaDiffs > 0;
+	}
+	MPI_Comm_free(&s->comm);
+	MPI_Finalize();
+	
+	free(s->playerMessage);
+	return replayFailed;
+}
+
+//returns nonzero if the command line is not understood
+int parseOptions(int argc, char *argv[], struct options * opts){
+	int i;
+	opts->comm = COMM_P2P;
+	opts->rounds = 0;		//the roster's
+	opts->output = OUTPUT_TEXT;
+	opts->tracePath = "match.trace";
+	opts->async = 0;
+	opts->timing = 0;
+	opts->profile = 0;
+	opts->tileCols = opts->tileRows = 0;
+	opts->seedSet = 0;
+	opts->seed = 0;
+	opts->replayPath = NULL;
+	opts->ensemble = 0;
+	opts->threads = 0;
+	opts->stats = 0;
+	opts->checkpointEvery = 0;
+	opts->checkpointPath = "match.ckpt";
+	opts->restartPath = NULL;
+	opts->rosterPath = NULL;
+	opts->replicate = 0;
+	opts->checkReplicas = 0;
+	opts->reorder = 0;
+	opts->telemetryName = NULL;
+	opts->speculate = 0;
+	for(i = 1; i < argc; i++){
+		if(strcmp(argv[i], "--comm") == 0 && i+1 < argc){
+			i++;
+			if(strcmp(argv[i], "p2p") == 0)
+				opts->comm = COMM_P2P;
+			else if(strcmp(argv[i], "coll") == 0)
+				opts->comm = COMM_COLL;
+			else if(strcmp(argv[i], "persist") == 0)
+				opts->comm = COMM_PERSIST;
+			else if(strcmp(argv[i], "shm") == 0)
+				opts->comm = COMM_SHM;
+			else if(strcmp(argv[i], "rma") == 0)
+				opts->comm = COMM_RMA;
+			else
+				return 1;
+		}
+		else if(strcmp(argv[i], "--rounds") == 0 && i+1 < argc){
+			opts->rounds = atoi(argv[++i]);
+			if(opts->rounds <= 0)
+				return 1;
+		}
+		else if(strcmp(argv[i], "--output") == 0 && i+1 < argc){
+			i++;
+			if(strcmp(argv[i], "text") == 0)
+				opts->output = OUTPUT_TEXT;
+			else if(strcmp(argv[i], "binary") == 0)
+				opts->output = OUTPUT_BINARY;
+			else if(strcmp(argv[i], "none") == 0)
+				opts->output = OUTPUT_NONE;
+			else if(strcmp(argv[i], "score") == 0)
+				opts->output = OUTPUT_SCORE;
+			else
+				return 1;
+		}
+		else if(strcmp(argv[i], "--trace") == 0 && i+1 < argc)
+			opts->tracePath = argv[++i];
+		else if(strcmp(argv[i], "--async") == 0)
+			opts->async = 1;
+		else if(strcmp(argv[i], "--timing") == 0)
+			opts->timing = 1;
+		else if(strcmp(argv[i], "--profile") == 0)
+			opts->profile = 1;
+		else if(strcmp(argv[i], "--tiles") == 0 && i+1 < argc){
+			if(sscanf(argv[++i], "%dx%d", &opts->tileCols, &opts->tileRows) != 2 || opts->tileCols <= 0 || opts->tileRows <= 0)
+				return 1;
+		}
+		else if(strcmp(argv[i], "--seed") == 0 && i+1 < argc){
+			opts->seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+			opts->seedSet = 1;
+		}
+		else if(strcmp(argv[i], "--replay") == 0 && i+1 < argc)
+			opts->replayPath = argv[++i];
+		else if(strcmp(argv[i], "--ensemble") == 0)
+			opts->ensemble = 1;
+		else if(strcmp(argv[i], "--stats") == 0)
+			opts->stats = 1;
+		else if(strcmp(argv[i], "--checkpoint") == 0 && i+1 < argc){
+			opts->checkpointEvery = atoi(argv[++i]);
+			if(opts->checkpointEvery <= 0)
+				return 1;
+		}
+		else if(strcmp(argv[i], "--checkpoint-file") == 0 && i+1 < argc)
+			opts->checkpointPath = argv[++i];
+		else if(strcmp(argv[i], "--restart") == 0 && i+1 < argc)
+			opts->restartPath = argv[++i];
+		else if(strcmp(argv[i], "--roster") == 0 && i+1 < argc)
+			opts->rosterPath = argv[++i];
+		else if(strcmp(argv[i], "--threads") == 0 && i+1 < argc){
+			opts->threads = atoi(argv[++i]);
+			if(opts->threads <= 0)
+				return 1;
+		}
+		else if(strcmp(argv[i], "--replicate") == 0)
+			opts->replicate = 1;
+		else if(strcmp(argv[i], "--check-replicas") == 0)
+			opts->replicate = opts->checkReplicas = 1;
+		else if(strcmp(argv[i], "--reorder") == 0)
+			opts->reorder = 1;
+		else if(strcmp(argv[i], "--speculate") == 0)
+			opts->speculate = 1;
+		else if(strcmp(argv[i], "--telemetry") == 0 && i+1 < argc){
+			opts->telemetryName = argv[++i];
+			if(opts->telemetryName[0] == '\0' || strchr(opts->telemetryName, '/') != NULL)
+				return 1;
+		}
+		else
+			return 1;
+	}
+	if(opts->ensemble && opts->replayPath != NULL)
+		return 1;
+	if(opts->output == OUTPUT_SCORE && opts->replayPath != NULL)		//nothing to compare
+		return 1;
+	if(opts->restartPath != NULL && opts->replayPath != NULL)		//the replay starts at round 0
+		return 1;
+	if(opts->threads && opts->comm != COMM_P2P)		//hosted players have their own round
+		return 1;
+	if(opts->replicate && (opts->comm != COMM_P2P || opts->tileCols || opts->threads))		//fp0/fp1 point to point only
+		return 1;
+	if(opts->speculate && (opts->comm != COMM_P2P || opts->tileCols || opts->threads))
+		return 1;
+	return 0;
+}
+
+/****************************************************
+*****ROUND: POINT TO POINT
+*****players send to both field processes, fp0 fans the ball out to every player
+***************************************************/
+void p2pRound(struct matchState * s){
+	int rank = s->rank;
+	int round = s->round;
+	int * ballCoords = s->ballCoords;
+	int * playerMessage = s->playerMessage;
+	int * ballChallengeInfo = s->ballChallengeInfo;
+	MPI_Request reqs[MAX_PROCESSES];
+	MPI_Status stat[MAX_PROCESSES];
+	long long t;
+	
+	/****************************************************
+	*****PLAYERS
+	***************************************************/
+	if(rank != FP0 && rank != FP1){
+		MPI_Request messages[3];
+		MPI_Request ballRequest[2];
+		MPI_Status ballRequestStatus[2];
+		
+		//Get ball coordinates
+		int ballSender;
+		if(round != 0){
+			MPI_Irecv(ballCoords, 2, MPI_INT, FP0, BALL_TAG, s->comm, &ballRequest[0]);
+			MPI_Irecv(ballCoords, 2, MPI_INT, FP1, MPI_ANY_TAG, s->comm, &ballRequest[1]);
+			t = probeStart(&s->prof);
+			MPI_Waitany(2, ballRequest, &ballSender, ballRequestStatus);
+			probeEnd(&s->prof, PHASE_BALL, t);
+			MPI_Cancel(&ballRequest[1-ballSender]);		//fp1 never sends the ball, don't leave its receive behind
+			MPI_Wait(&ballRequest[1-ballSender], MPI_STATUS_IGNORE);
+		}
+		
+		//send our message: 1 to our corresopnding field process, and 1 to the other field process as dummy.
+		//a move made last round for the ball as it was is already sent, and stands if the ball stayed
+		int dummyMessage[PLYR_MSG_SIZE];
+		int speculated = s->spec.pending;
+		messages[0] = messages[1] = MPI_REQUEST_NULL;
+		if(speculated && ballCoords[X] == s->spec.ball[X] && ballCoords[Y] == s->spec.ball[Y])
+			specCommit(s);
+		else{
+			if(speculated)
+				s->spec.redoneNs += s->spec.moveNs;
+			int reached = playerMove(s);
+			p2pSend(s, playerMessage, dummyMessage, reached, speculated ? SPEC_FIX_TAG : MESSAGE_TAG, messages);
+		}
+		
+		//round finish, send all info for printing
+		messages[2] = MPI_REQUEST_NULL;
+		if(s->needInfo)
+			MPI_Isend(s->playerInfo, PLYR_INFO_SIZE, MPI_INT, FP0, INFO_TAG, s->comm, &messages[2]);
+		t = probeStart(&s->prof);
+		MPI_Waitall(3, messages, MPI_STATUSES_IGNORE);
+		probeEnd(&s->prof, PHASE_SEND, t);
+		if(s->speculate)
+			specMove(s);
+	}/************************************END OF PLAYER PROCESS***************************************/
+	else{	
+		/****************************************************************************
+		****FIELD PROCESSES
+		****************************************************************************/
+		MPI_Request sendBallCoordsReqs[MAX_PLAYERS];
+		MPI_Request recvMsg[2*MAX_PLAYERS];
+		MPI_Request challengeReq = MPI_REQUEST_NULL;
+		int i;
+		if(rank == FP0)
+			outputRoundStart(s);
 
-			//send ball coordinates
-			if(round != 0){
-				if(rank == FP0){
-					for(i = 2; i < PROCESSES; i++)
-							MPI_Isend(ballCoords, 2, MPI_INT, i, ballTag, MPI_COMM_WORLD, &sendBallCoordsReqs[rank]);
-				}
+		//send ball coordinates
+		if(round != 0){
+			if(rank == FP0){
+				for(i = 2; i < PROCESSES; i++)
+						MPI_Isend(ballCoords, 2, MPI_INT, i, BALL_TAG, s->comm, &sendBallCoordsReqs[i-2]);
 			}
-			
-			//recv all player messages
+		}
+		
+		//recv all player messages. under --speculate they were sent last round for last round's ball, so if the
+		//ball has moved since they go to stale and the redone moves follow
+		int startBall[2] = {ballCoords[X], ballCoords[Y]};
+		int missed = s->spec.pending && (ballCoords[X] != s->spec.ball[X] || ballCoords[Y] != s->spec.ball[Y]);
+		for(i = 2; i < PROCESSES; i++)
+			MPI_Irecv((missed ? s->spec.stale : playerMessage)+(i*PLYR_MSG_SIZE), PLYR_MSG_SIZE, MPI_INT, i, MESSAGE_TAG, s->comm, &recvMsg[i-2]);
+		if(missed){
 			for(i = 2; i < PROCESSES; i++)
-				MPI_Irecv(playerMessage+(i*PLYR_MSG_SIZE), PLYR_MSG_SIZE, MPI_INT, i, messageTag, MPI_COMM_WORLD, &recvMsg[i-2]);
-				
-			//if i'm the field process with the ball, go on to handle ball challenge
-			if(rank == fieldProcess(ballCoords)){	
-				int drawBuf[PROCESSES];
-				int drawCount = 0;
-				int winBallRank = -1;
-				int maxBallChallenge = -1;
-			
-				MPI_Waitall(10, recvMsg, recvMsgStatus);	//wait for all messages to be received
-				
-				//get max ball challenges, or find out if any draw in ball challenges
-				for(i = 2; i < PROCESSES; i++){
-					int * currPlayer = playerMessage+(i*PLYR_MSG_SIZE);
-					if(*currPlayer == -1)
-						continue;
-					if(*(currPlayer+CHAL_SCR) == -1){
-					}
-					else{
-						if(*(currPlayer+CHAL_SCR) > maxBallChallenge){
-							drawCount = 0;
-							maxBallChallenge = *(currPlayer+CHAL_SCR);
-							winBallRank = i;
-						}
-						else if(*(currPlayer+CHAL_SCR) == maxBallChallenge)
-							drawBuf[drawCount++] = i;
-					}
-				}
-				
-				if(drawCount > 1)		//if there's a draw, we pick 1 winner randomly
-						winBallRank = drawBuf[rand() % drawCount];
-			
-				if(winBallRank > 0){		//the winner of the ball challenge (-1 if no challenges)
-					int * winBallPlayer = playerMessage+(winBallRank*PLYR_MSG_SIZE);
-					int shotLocation[2] = {128, 32};
-					int points = 0;
-					//set player's scoring grid
-					if(round < 2700){
-						if(winBallRank >= 7)
-							shotLocation[X] = 0;
-					}
-					else{
-						if(winBallRank < 7)
-							shotLocation[X] = 0;
-					}
-					int distToGoal = abs(*(winBallPlayer+X) - shotLocation[X]) + abs(*(winBallPlayer+Y) - shotLocation[Y]);
-					
-					//if the ball is already at the scoring grid, we simply add 2 points
-					if(*(winBallPlayer+X) == shotLocation[X] && *(winBallPlayer+Y) == shotLocation[Y])
-						points = 2;
-					else{
-						if(*(winBallPlayer+SHOT_TYPE) == SCORE){		//if the player wishes to score
-							determineShot(*(winBallPlayer+SHOOT_SKILL), winBallPlayer, shotLocation, ballCoords);						
-						}
-						else{		//player wishes to pass
-							//we find teammate closest to score grid
-							int * targetTeammate = winBallPlayer;
-							int * currPlayer;
-							
-							if(winBallRank < 7){
-								for(i = 2; i < 7; i++){
-									currPlayer = playerMessage+(i*PLYR_MSG_SIZE);
-									if(*(currPlayer+RND_NO) == round && abs(*(currPlayer+X)-shotLocation[X])+abs(*(currPlayer+Y)-shotLocation[Y]) < distToGoal){
-										distToGoal = abs(*(currPlayer+X)-shotLocation[X])+abs(*(currPlayer+Y)-shotLocation[Y]);
-										targetTeammate = currPlayer;
-									}
-								}
-								if(targetTeammate != winBallPlayer){
-									shotLocation[X] = *(targetTeammate+X);
-									shotLocation[Y] = *(targetTeammate+Y);
-								}
-							}
-							else{
-								for(i = 7; i < 12; i++){
-									currPlayer = playerMessage+(i*PLYR_MSG_SIZE);
-									if(*(currPlayer+RND_NO) == round && abs(*(currPlayer+X)-shotLocation[X])+abs(*(currPlayer+Y)-shotLocation[Y]) < distToGoal){
-										distToGoal = abs(*(currPlayer+X)-shotLocation[X])+abs(*(currPlayer+Y)-shotLocation[Y]);
-										targetTeammate = currPlayer;
-									}
-								}
-								if(targetTeammate != winBallPlayer){
-									shotLocation[X] = *(targetTeammate+X);
-									shotLocation[Y] = *(targetTeammate+Y);
-								}
-							}
-							
-							if(targetTeammate == winBallPlayer)	//already the player with ball is already nearest to score grid, he tries his luck
-								determineShot(*(winBallPlayer+SHOOT_SKILL), winBallPlayer, shotLocation, ballCoords);			
-							else{
-								determineShot(*(currPlayer+SHOOT_SKILL), currPlayer, shotLocation, ballCoords);			
-							}
-						}
-			
-						//determine score
-						if(ballCoords[Y] == 32 && (ballCoords[X] == 128 || ballCoords[X] == 0)){
-							points = distToGoal < 24 ? 2 : 3;
-							ballCoords[X] = 64;	//start from center after scoring
-							ballCoords[Y] = 32;
-						}
-					}
-					
-					//message to sync information between field processes
-					ballChallengeInfo[0] = winBallRank;
-					ballChallengeInfo[1] = shotLocation[0];
-					ballChallengeInfo[2] = shotLocation[1];
-					ballChallengeInfo[3] = ballCoords[0];
-					ballChallengeInfo[4] = ballCoords[1];
-					ballChallengeInfo[5] = points;
-					ballChallengeInfo[6] = winBallRank < 7 ? 0 : 1;
-				}
-				else{	//no ball challenges
-					ballChallengeInfo[0] = winBallRank;
-					ballChallengeInfo[1] = -1;
-					ballChallengeInfo[2] = -1;
-					ballChallengeInfo[3] = ballCoords[0];
-					ballChallengeInfo[4] = ballCoords[1];
-					ballChallengeInfo[5] = 0;
-					ballChallengeInfo[6] = -1;
-				}			
-				
-				//field process sends information about ball challenge 
-				if(rank == FP1)
-					MPI_Isend(ballChallengeInfo, 7, MPI_INT, 0, ballChallengeTag, MPI_COMM_WORLD, &reqs[rank]);
-				else
-					MPI_Isend(ballChallengeInfo, 7, MPI_INT, 1, ballChallengeTag, MPI_COMM_WORLD, &reqs[rank]);
+				MPI_Irecv(playerMessage+(i*PLYR_MSG_SIZE), PLYR_MSG_SIZE, MPI_INT, i, SPEC_FIX_TAG, s->comm, &recvMsg[PLAYERS+i-2]);
+		}
+		long long waitStart = s->speculate ? wall_clock_time() : 0;
+		t = probeStart(&s->prof);
+		MPI_Waitall(missed ? 2*PLAYERS : PLAYERS, recvMsg, MPI_STATUSES_IGNORE);	//wait for all messages to be received, the dummies too
+		probeEnd(&s->prof, PHASE_MSG, t);
+		if(rank == FP0 && s->spec.pending){
+			if(missed){
+				s->spec.misses++;
+				s->spec.missWaitNs += wall_clock_time() - waitStart;
 			}
-			else{	//i'm the field process without the ball, i simply wait
-				if(rank == FP0){
-					MPI_Irecv(ballChallengeInfo, 7, MPI_INT, 1, ballChallengeTag, MPI_COMM_WORLD, &reqs[rank]);
-					MPI_Wait(&reqs[rank], &stat[rank]);	//wait for ball challenge info from fp1
-					ballCoords[X] = ballChallengeInfo[3];
-					ballCoords[Y] = ballChallengeInfo[4];
-				}
-				else{
-					MPI_Irecv(ballChallengeInfo, 7, MPI_INT, 0, ballChallengeTag, MPI_COMM_WORLD, &reqs[rank]);
-					MPI_Wait(&reqs[rank], &stat[rank]);	//wait for ball challenge info from fp1
-					ballCoords[X] = ballChallengeInfo[3];
-					ballCoords[Y] = ballChallengeInfo[4];
-				}
+			else{
+				s->spec.hits++;
+				s->spec.hitWaitNs += wall_clock_time() - waitStart;
 			}
+		}
+		if(s->speculate){		//the guess the players make for the next round
+			s->spec.ball[X] = startBall[X];
+			s->spec.ball[Y] = startBall[Y];
+			s->spec.pending = round+1 < s->rounds;
+		}
+		
+		//every player has the ball by now, so the ball sends are done before ballCoords changes
+		if(rank == FP0 && round != 0)
+			MPI_Waitall(PLAYERS, sendBallCoordsReqs, MPI_STATUSES_IGNORE);
 			
-			//for round printing
+		//replicas both resolve the challenge from the same messages and draws, so neither waits for the other
+		if(s->replicate){
+			resolveChallenge(s);
+			if(s->checkReplicas)
+				replicaCheck(s, &challengeReq);
+		}
+		//if i'm the field process with the ball, go on to handle ball challenge
+		else if(rank == fieldProcess(ballCoords)){	
+			resolveChallenge(s);
+			
+			//field process sends information about ball challenge 
+			if(rank == FP1)
+				MPI_Isend(ballChallengeInfo, 7, MPI_INT, 0, BALL_CHALLENGE_TAG, s->comm, &challengeReq);
+			else
+				MPI_Isend(ballChallengeInfo, 7, MPI_INT, 1, BALL_CHALLENGE_TAG, s->comm, &challengeReq);
+		}
+		else{	//i'm the field process without the ball, i simply wait
 			if(rank == FP0){
-				//get all player info for printing
-				int i;
-				for(i = 2; i < PROCESSES; i++)
-					MPI_Irecv(allPlayerInfo+i*9, 9, MPI_INT, i, infoTag, MPI_COMM_WORLD, &reqs[i]);
-				MPI_Waitall(PLAYERS, &reqs[2], &stat[2]);			
-				
-				//set the newly sync information
-				score[ballChallengeInfo[6]] += ballChallengeInfo[5];
-				*(allPlayerInfo+(ballChallengeInfo[0]*9 + SHOOT_X)) = ballChallengeInfo[1];
-				*(allPlayerInfo+(ballChallengeInfo[0]*9 + SHOOT_Y)) = ballChallengeInfo[2];
-				*(allPlayerInfo+(ballChallengeInfo[0]*9 + WIN_RND)) = 1;
+				MPI_Irecv(ballChallengeInfo, 7, MPI_INT, 1, BALL_CHALLENGE_TAG, s->comm, &reqs[rank]);
+				t = probeStart(&s->prof);
+				MPI_Wait(&reqs[rank], &stat[rank]);	//wait for ball challenge info from fp1
+				probeEnd(&s->prof, PHASE_CHALLENGE, t);
+				ballCoords[X] = ballChallengeInfo[3];
+				ballCoords[Y] = ballChallengeInfo[4];
+			}
+			else{
+				MPI_Irecv(ballChallengeInfo, 7, MPI_INT, 0, BALL_CHALLENGE_TAG, s->comm, &reqs[rank]);
+				t = probeStart(&s->prof);
+				MPI_Wait(&reqs[rank], &stat[rank]);	//wait for ball challenge info from fp1
+				probeEnd(&s->prof, PHASE_CHALLENGE, t);
 				ballCoords[X] = ballChallengeInfo[3];
 				ballCoords[Y] = ballChallengeInfo[4];
-				
-				int * currPlayer = allPlayerInfo + 18;
-
-				for(i = 2; i < 7; i++){
-					printf("%d %d %d %d %d %d %d %d %d %d\n", i-2, *(currPlayer+INIT_X), *(currPlayer+INIT_Y), *(currPlayer+END_X),
-						*(currPlayer+END_Y), *(currPlayer+REACH_RND), *(currPlayer+WIN_RND), *(currPlayer+CHALLENGE), *(currPlayer+SHOOT_X), *(currPlayer+SHOOT_Y));
-					currPlayer += 9;
-				}
-				for(; i < PROCESSES; i++){
-					printf("%d %d %d %d %d %d %d %d %d %d\n", i-7, *(currPlayer+INIT_X), *(currPlayer+INIT_Y), *(currPlayer+END_X), *
-						(currPlayer+END_Y), *(currPlayer+REACH_RND), *(currPlayer+WIN_RND), *(currPlayer+CHALLENGE), *(currPlayer+SHOOT_X), *(currPlayer+SHOOT_Y));
-					currPlayer += 9;
-				}
 			}
 		}
+		
+		//for round printing
+		if(rank == FP0){
+			//get all player info for printing
+			if(s->needInfo){
+				for(i = 2; i < PROCESSES; i++)
+					MPI_Irecv(s->allPlayerInfo+i*9, 9, MPI_INT, i, INFO_TAG, s->comm, &reqs[i]);
+				t = probeStart(&s->prof);
+				MPI_Waitall(PLAYERS, &reqs[2], &stat[2]);
+				probeEnd(&s->prof, PHASE_INFO, t);
+			}
+			
+			applyBallChallenge(s);
+			outputRoundEnd(s);
+		}
+		MPI_Wait(&challengeReq, MPI_STATUS_IGNORE);
 	}
-	if(rank == FP0){
-		after = wall_clock_time();
-		//printf("%1.5f sec\n", (float)(after-before)/1000000000);
+}
+
+/****************************************************
+*****ROUND: COLLECTIVES
+*****the ball owner gathers the player messages, fp0 gathers player info for printing,
+*****and the ball owner broadcasts the challenge result (which carries the next ball coordinates)
+***************************************************/
+void collectiveRound(struct matchState * s){
+	int rank = s->rank;
+	int root = fieldProcess(s->ballCoords);		//every rank agrees on the ball owner
+	int dummyInfo[PLYR_INFO_SIZE];
+	MPI_Request infoReq = MPI_REQUEST_NULL;
+	long long t;
+	
+	if(rank == FP0)
+		outputRoundStart(s);
+	
+	if(rank != FP0 && rank != FP1){
+		playerMove(s);
+		if(s->needInfo)
+			MPI_Igather(s->playerInfo, PLYR_INFO_SIZE, MPI_INT, NULL, PLYR_INFO_SIZE, MPI_INT, FP0, s->comm, &infoReq);
+		t = probeStart(&s->prof);
+		MPI_Gather(s->playerMessage, PLYR_MSG_SIZE, MPI_INT, NULL, PLYR_MSG_SIZE, MPI_INT, root, s->comm);
+		probeEnd(&s->prof, PHASE_SEND, t);
+	}
+	else{
+		//field processes contribute a dummy slot to the gathers they do not root
+		if(s->needInfo && rank == FP0)
+			MPI_Igather(MPI_IN_PLACE, PLYR_INFO_SIZE, MPI_INT, s->allPlayerInfo, PLYR_INFO_SIZE, MPI_INT, FP0, s->comm, &infoReq);
+		else if(s->needInfo)
+			MPI_Igather(dummyInfo, PLYR_INFO_SIZE, MPI_INT, NULL, PLYR_INFO_SIZE, MPI_INT, FP0, s->comm, &infoReq);
+		if(rank == root){
+			t = probeStart(&s->prof);
+			MPI_Gather(MPI_IN_PLACE, PLYR_MSG_SIZE, MPI_INT, s->playerMessage, PLYR_MSG_SIZE, MPI_INT, root, s->comm);
+			probeEnd(&s->prof, PHASE_MSG, t);
+			resolveChallenge(s);
+		}
+		else{
+			s->playerMessage[rank*PLYR_MSG_SIZE+X] = -1;
+			MPI_Gather(s->playerMessage+rank*PLYR_MSG_SIZE, PLYR_MSG_SIZE, MPI_INT, NULL, PLYR_MSG_SIZE, MPI_INT, root, s->comm);
+		}
 	}
-	MPI_Finalize();
 	
-	free(playerMessage);
-	return 0;
+	t = probeStart(&s->prof);
+	MPI_Bcast(s->ballChallengeInfo, 7, MPI_INT, root, s->comm);
+	probeEnd(&s->prof, PHASE_CHALLENGE, t);
+	s->ballCoords[X] = s->ballChallengeInfo[3];
+	s->ballCoords[Y] = s->ballChallengeInfo[4];
+	t = probeStart(&s->prof);
+	MPI_Wait(&infoReq, MPI_STATUS_IGNORE);
+	probeEnd(&s->prof, rank == FP0 ? PHASE_INFO : PHASE_SEND, t);
+	
+	if(rank == FP0){
+		applyBallChallenge(s);
+		outputRoundEnd(s);
+	}
 }
 
-//function to reset round variables of a player
-void initInfo(int * info){
-	*(info+INIT_X) = *(info+END_X);
-	*(info+INIT_Y) = *(info+END_Y);
-	*(info+REACH_RND) = *(info+WIN_RND) = 0;
-	*(info+CHALLENGE) = *(info+SHOOT_X) = *(info+SHOOT_Y) = -1;
+/****************************************************
+*****ROUND: PERSISTENT REQUESTS
+*****same messages as p2p, but every request is created once and restarted each round
+***************************************************/
+void persistentSetup(struct matchState * s){
+	struct persistentReqs * p = &s->persist;
+	int rank = s->rank;
+	int i;
+	
+	if(rank != FP0 && rank != FP1){
+		MPI_Recv_init(s->ballCoords, 2, MPI_INT, FP0, BALL_TAG, s->comm, &p->ball[0]);
+		MPI_Send_init(p->fpMessage[FP0], PLYR_MSG_SIZE, MPI_INT, FP0, MESSAGE_TAG, s->comm, &p->msg[FP0]);
+		MPI_Send_init(p->fpMessage[FP1], PLYR_MSG_SIZE, MPI_INT, FP1, MESSAGE_TAG, s->comm, &p->msg[FP1]);
+		p->info[0] = MPI_REQUEST_NULL;
+		if(s->needInfo)
+			MPI_Send_init(s->playerInfo, PLYR_INFO_SIZE, MPI_INT, FP0, INFO_TAG, s->comm, &p->info[0]);
+	}
+	else{
+		for(i = 2; i < PROCESSES; i++){
+			MPI_Recv_init(s->playerMessage+(i*PLYR_MSG_SIZE), PLYR_MSG_SIZE, MPI_INT, i, MESSAGE_TAG, s->comm, &p->msg[i]);
+			if(rank == FP0){
+				MPI_Send_init(s->ballCoords, 2, MPI_INT, i, BALL_TAG, s->comm, &p->ball[i]);
+				p->info[i] = MPI_REQUEST_NULL;
+				if(s->needInfo)
+					MPI_Recv_init(s->allPlayerInfo+i*PLYR_INFO_SIZE, PLYR_INFO_SIZE, MPI_INT, i, INFO_TAG, s->comm, &p->info[i]);
+			}
+		}
+		MPI_Send_init(s->ballChallengeInfo, 7, MPI_INT, 1-rank, BALL_CHALLENGE_TAG, s->comm, &p->challengeSend);
+		MPI_Recv_init(s->ballChallengeInfo, 7, MPI_INT, 1-rank, BALL_CHALLENGE_TAG, s->comm, &p->challengeRecv);
+	}
+	p->challengeStarted = 0;
 }
 
-void runStrategy(int rank, int round, int * ballCoords, int * startPos, int * endPos, int speed){
-	if(rank == 5 || rank == 6 || rank == 10 || rank == 11){		//designated ball chasers
-		runTowardsBall(*ballCoords, *(ballCoords+1), *startPos, *(startPos+1), endPos, endPos+1, speed);
+void persistentRound(struct matchState * s){
+	struct persistentReqs * p = &s->persist;
+	int rank = s->rank;
+	int round = s->round;
+	long long t;
+	
+	if(rank != FP0 && rank != FP1){
+		if(round != 0){
+			MPI_Start(&p->ball[0]);
+			t = probeStart(&s->prof);
+			MPI_Wait(&p->ball[0], MPI_STATUS_IGNORE);
+			probeEnd(&s->prof, PHASE_BALL, t);
+			t = probeStart(&s->prof);
+			MPI_Waitall(2, p->msg, MPI_STATUSES_IGNORE);		//last round's sends, before we touch their buffers
+			MPI_Wait(&p->info[0], MPI_STATUS_IGNORE);
+			probeEnd(&s->prof, PHASE_SEND, t);
+		}
+		
+		int reached = playerMove(s);
+		int fp = fieldProcess(s->ballCoords);
+		memcpy(p->fpMessage[fp], s->playerMessage, sizeof(p->fpMessage[fp]));
+		memcpy(p->fpMessage[1-fp], s->playerMessage, sizeof(p->fpMessage[fp]));
+		if(reached)
+			p->fpMessage[1-fp][X] = -1;	//set message as dummy
+		MPI_Startall(2, p->msg);
+		if(s->needInfo)
+			MPI_Start(&p->info[0]);
 	}
 	else{
-		if(nearBall(startPos, ballCoords, speed)){
-			runTowardsBall(*ballCoords, *(ballCoords+1), *startPos, *(startPos+1), endPos, endPos+1, speed);
+		if(rank == FP0){
+			outputRoundStart(s);
+			if(round != 0)
+				MPI_Startall(PLAYERS, &p->ball[2]);
+		}
+		
+		MPI_Startall(PLAYERS, &p->msg[2]);
+		t = probeStart(&s->prof);
+		MPI_Waitall(PLAYERS, &p->msg[2], MPI_STATUSES_IGNORE);
+		probeEnd(&s->prof, PHASE_MSG, t);
+		if(rank == FP0 && round != 0)
+			MPI_Waitall(PLAYERS, &p->ball[2], MPI_STATUSES_IGNORE);
+		
+		if(rank == fieldProcess(s->ballCoords)){
+			resolveChallenge(s);
+			MPI_Start(&p->challengeSend);
+			p->challengeStarted = 1;
 		}
 		else{
-			if(isOffenseSide(rank, ballCoords, round)){	//if ball is in my attacking half, run towards my attacking half
-				runOffenseDirection(rank, round, *(startPos), *(startPos+1), endPos, endPos+1, speed);
+			MPI_Start(&p->challengeRecv);
+			t = probeStart(&s->prof);
+			MPI_Wait(&p->challengeRecv, MPI_STATUS_IGNORE);
+			probeEnd(&s->prof, PHASE_CHALLENGE, t);
+			s->ballCoords[X] = s->ballChallengeInfo[3];
+			s->ballCoords[Y] = s->ballChallengeInfo[4];
+		}
+		
+		if(rank == FP0){
+			if(s->needInfo){
+				MPI_Startall(PLAYERS, &p->info[2]);
+				t = probeStart(&s->prof);
+				MPI_Waitall(PLAYERS, &p->info[2], MPI_STATUSES_IGNORE);
+				probeEnd(&s->prof, PHASE_INFO, t);
 			}
-			else{ //else run towards my defensive half
-				runDefenseDirection(rank, round, *(startPos), *(startPos+1), endPos, endPos+1, speed);
+			applyBallChallenge(s);
+			outputRoundEnd(s);
+		}
+		if(p->challengeStarted){
+			MPI_Wait(&p->challengeSend, MPI_STATUS_IGNORE);
+			p->challengeStarted = 0;
+		}
+	}
+}
+
+void persistentTeardown(struct matchState * s){
+	struct persistentReqs * p = &s->persist;
+	int rank = s->rank;
+	int i;
+	
+	if(rank != FP0 && rank != FP1){
+		MPI_Waitall(2, p->msg, MPI_STATUSES_IGNORE);
+		MPI_Wait(&p->info[0], MPI_STATUS_IGNORE);
+		MPI_Request_free(&p->ball[0]);
+		MPI_Request_free(&p->msg[FP0]);
+		MPI_Request_free(&p->msg[FP1]);
+		if(s->needInfo)
+			MPI_Request_free(&p->info[0]);
+	}
+	else{
+		for(i = 2; i < PROCESSES; i++){
+			MPI_Request_free(&p->msg[i]);
+			if(rank == FP0){
+				MPI_Request_free(&p->ball[i]);
+				if(s->needInfo)
+					MPI_Request_free(&p->info[i]);
 			}
 		}
+		MPI_Request_free(&p->challengeSend);
+		MPI_Request_free(&p->challengeRecv);
 	}
 }
 
-//function checks if player is near to ball
-int nearBall(int * location, int * ballLocation, int dist){
-	int totalDist = abs(*location - *ballLocation) + abs(*(location+1) - *(ballLocation+1));
-	if(totalDist < 5 * dist)
-		return 1;
+/****************************************************
+*****ROUND: ONE-SIDED
+*****players store their message into the ball owner's board and their info into fp0's, the owner stores
+*****the challenge result into every board. two barriers a round, no messages through the mpi stack on a node
+***************************************************/
+void rmaSetup(struct matchState * s, int wantShared){
+	struct rmaState * r = &s->rma;
+	MPI_Comm node;
+	int size, nodeSize, disp;
+	MPI_Aint bytes;
+	
+	MPI_Comm_size(s->comm, &size);
+	MPI_Comm_split_type(s->comm, MPI_COMM_TYPE_SHARED, s->rank, MPI_INFO_NULL, &node);
+	MPI_Comm_size(node, &nodeSize);
+	MPI_Comm_free(&node);
+	r->shared = wantShared && nodeSize == size;		//a match spread over nodes falls back to puts
+	if(r->shared){
+		MPI_Win_allocate_shared(s->rank == FP0 ? sizeof(struct rmaBoard) : 0, sizeof(int), MPI_INFO_NULL, s->comm, &r->board, &r->win);
+		MPI_Win_shared_query(r->win, FP0, &bytes, &disp, &r->board);
+	}
+	else
+		MPI_Win_allocate(sizeof(struct rmaBoard), sizeof(int), MPI_INFO_NULL, s->comm, &r->board, &r->win);
+	if(s->rank == FP0 || s->rank == FP1){		//the owner resolves straight from the board
+		r->ownMessages = s->playerMessage;
+		s->playerMessage = r->board->playerMessage;
+	}
+	MPI_Win_lock_all(MPI_MODE_NOCHECK, r->win);		//one passive target epoch for the whole match
+}
+
+//count ints from src to offset ints into target's board
+static void rmaStore(struct rmaState * r, int target, int offset, int * src, int count){
+	if(r->shared)
+		memcpy((int *)r->board + offset, src, count*sizeof(int));
 	else
-		return 0;
+		MPI_Put(src, count, MPI_INT, target, offset, count, MPI_INT, r->win);
+}
+
+//completes this rank's stores, and makes everyone's visible to it
+static void rmaSync(struct matchState * s){
+	if(!s->rma.shared)
+		MPI_Win_flush_all(s->rma.win);
+	MPI_Win_sync(s->rma.win);
+	MPI_Barrier(s->comm);
+	MPI_Win_sync(s->rma.win);
 }
 
-//functions return true if ball is in player's offensive side, and false otherwise
-int isOffenseSide(int rank, int * ball, int round){
-	if(round < 2700){
-		if(rank < 7)	//attack right side
-			return *ball <= 64 ? 0 : 1;
-		else		//attack left side
-			return *ball > 64 ? 0 : 1;
+void rmaRound(struct matchState * s){
+	struct rmaState * r = &s->rma;
+	struct rmaBoard * b = r->board;
+	int rank = s->rank;
+	int owner = fieldProcess(s->ballCoords);		//every rank agrees on the ball owner
+	long long t;
+	int i;
+	
+	if(rank == FP0)
+		outputRoundStart(s);
+	if(rank != FP0 && rank != FP1){
+		playerMove(s);
+		rmaStore(r, owner, offsetof(struct rmaBoard, playerMessage)/sizeof(int) + s->id*PLYR_MSG_SIZE, s->playerMessage, PLYR_MSG_SIZE);
+		if(s->needInfo)
+			rmaStore(r, FP0, offsetof(struct rmaBoard, playerInfo)/sizeof(int) + s->id*PLYR_INFO_SIZE, s->playerInfo, PLYR_INFO_SIZE);
 	}
-	else{
-		if(rank < 7)
-			return *ball <= 64 ? 1 : 0;
-		else
-			return *ball > 64 ? 1 : 0;
+	t = probeStart(&s->prof);
+	rmaSync(s);
+	probeEnd(&s->prof, rank != FP0 && rank != FP1 ? PHASE_SEND : PHASE_MSG, t);
+	
+	//players store into the board again next round, after the second barrier, so fp0 takes its copy now
+	if(rank == FP0 && s->needInfo)
+		memcpy(s->allPlayerInfo+2*PLYR_INFO_SIZE, b->playerInfo+2*PLYR_INFO_SIZE, PLAYERS*PLYR_INFO_SIZE*sizeof(int));
+	if(rank == owner){
+		resolveChallenge(s);
+		if(r->shared)
+			memcpy(b->ballChallengeInfo, s->ballChallengeInfo, sizeof(b->ballChallengeInfo));
+		else{
+			for(i = 0; i < PROCESSES; i++){
+				if(i != rank)
+					rmaStore(r, i, offsetof(struct rmaBoard, ballChallengeInfo)/sizeof(int), s->ballChallengeInfo, 7);
+			}
+		}
 	}
+	t = probeStart(&s->prof);
+	rmaSync(s);
+	probeEnd(&s->prof, PHASE_CHALLENGE, t);
+	
+	if(rank != owner)
+		memcpy(s->ballChallengeInfo, b->ballChallengeInfo, sizeof(b->ballChallengeInfo));
+	s->ballCoords[X] = s->ballChallengeInfo[3];
+	s->ballCoords[Y] = s->ballChallengeInfo[4];
+	if(rank == FP0){
+		applyBallChallenge(s);
+		outputRoundEnd(s);
+	}
+}
+
+void rmaTeardown(struct matchState * s){
+	struct rmaState * r = &s->rma;
+	MPI_Win_unlock_all(r->win);
+	if(s->rank == FP0 || s->rank == FP1)
+		s->playerMessage = r->ownMessages;
+	MPI_Win_free(&r->win);
 }
 
-void runOffenseDirection(int rank, int round, int currX, int currY, int *resultX, int * resultY, int distance){
-	//if already in offense zone, stay
-	if(round < 2700){
-		if(rank < 7){	//attack right side
-			if(currX < 108 || abs(currY - 32) > 16)
-				run(128,32,resultX,resultY,distance);
+/****************************************************
+*****ROUND: K-WAY TILES
+*****the court is a grid of field process tiles. players send their message only to the tile that owns
+*****the ball, which resolves the challenge and sends the result straight to every other rank
+***************************************************/
+void tiledRound(struct matchState * s){
+	int rank = s->rank;
+	int numtasks = s->fieldCount + PLAYERS;
+	int owner = fieldTile(s->ballCoords, s->tileCols, s->tileRows);	//every rank agrees on the ball owner
+	MPI_Request reqs[2*MAX_PLAYERS];
+	long long t;
+	int i;
+	
+	if(rank >= s->fieldCount){
+		playerMove(s);
+		MPI_Isend(s->playerMessage, PLYR_MSG_SIZE, MPI_INT, owner, MESSAGE_TAG, s->comm, &reqs[0]);
+		reqs[1] = MPI_REQUEST_NULL;
+		if(s->needInfo)
+			MPI_Isend(s->playerInfo, PLYR_INFO_SIZE, MPI_INT, FP0, INFO_TAG, s->comm, &reqs[1]);
+		t = probeStart(&s->prof);
+		MPI_Recv(s->ballChallengeInfo, 7, MPI_INT, owner, BALL_CHALLENGE_TAG, s->comm, MPI_STATUS_IGNORE);
+		probeEnd(&s->prof, PHASE_CHALLENGE, t);
+		t = probeStart(&s->prof);
+		MPI_Waitall(2, reqs, MPI_STATUSES_IGNORE);
+		probeEnd(&s->prof, PHASE_SEND, t);
+		s->ballCoords[X] = s->ballChallengeInfo[3];
+		s->ballCoords[Y] = s->ballChallengeInfo[4];
+		return;
+	}
+	
+	if(rank == FP0){
+		outputRoundStart(s);
+		for(i = 0; i < PLAYERS; i++){
+			reqs[PLAYERS+i] = MPI_REQUEST_NULL;
+			if(s->needInfo)
+				MPI_Irecv(s->allPlayerInfo+(i+2)*PLYR_INFO_SIZE, PLYR_INFO_SIZE, MPI_INT, s->fieldCount+i, INFO_TAG, s->comm, &reqs[PLAYERS+i]);
+		}
+	}
+	
+	if(rank == owner){
+		MPI_Request * sends = malloc((numtasks-1)*sizeof(MPI_Request));
+		int n = 0;
+		for(i = 0; i < PLAYERS; i++)
+			MPI_Irecv(s->playerMessage+(i+2)*PLYR_MSG_SIZE, PLYR_MSG_SIZE, MPI_INT, s->fieldCount+i, MESSAGE_TAG, s->comm, &reqs[i]);
+		t = probeStart(&s->prof);
+		MPI_Waitall(PLAYERS, reqs, MPI_STATUSES_IGNORE);
+		probeEnd(&s->prof, PHASE_MSG, t);
+		resolveChallenge(s);
+		for(i = 0; i < numtasks; i++){
+			if(i != rank)
+				MPI_Isend(s->ballChallengeInfo, 7, MPI_INT, i, BALL_CHALLENGE_TAG, s->comm, &sends[n++]);
 		}
-		else{	//attack left side
-			if(currX > 20 || abs(currY - 32) > 16)
-				run(0,32,resultX,resultY,distance);
+		if(rank == FP0){
+			t = probeStart(&s->prof);
+			MPI_Waitall(PLAYERS, &reqs[PLAYERS], MPI_STATUSES_IGNORE);
+			probeEnd(&s->prof, PHASE_INFO, t);
+			applyBallChallenge(s);
+			outputRoundEnd(s);
 		}
+		MPI_Waitall(n, sends, MPI_STATUSES_IGNORE);
+		free(sends);
 	}
 	else{
-		if(rank < 7){	//attack left side
-			if(currX > 20 || abs(currY - 32) > 16)
-				run(0,32,resultX,resultY,distance);
-		}
-		else{
-			if(currX < 108 || abs(currY -32) > 16)
-				run(128,32,resultX,resultY,distance);
+		t = probeStart(&s->prof);
+		MPI_Recv(s->ballChallengeInfo, 7, MPI_INT, owner, BALL_CHALLENGE_TAG, s->comm, MPI_STATUS_IGNORE);
+		probeEnd(&s->prof, PHASE_CHALLENGE, t);
+		s->ballCoords[X] = s->ballChallengeInfo[3];
+		s->ballCoords[Y] = s->ballChallengeInfo[4];
+		if(rank == FP0){
+			t = probeStart(&s->prof);
+			MPI_Waitall(PLAYERS, &reqs[PLAYERS], MPI_STATUSES_IGNORE);
+			probeEnd(&s->prof, PHASE_INFO, t);
+			applyBallChallenge(s);
+			outputRoundEnd(s);
 		}
 	}
 }
 
-void runDefenseDirection(int rank, int round, int currX, int currY, int *resultX, int * resultY, int distance){
-	//if already in defense zone, stay
-	if(round < 2700){
-		if(rank < 7){	//attack right side
-			if(currX > 20 || abs(currY - 32) > 16){
-				run(0,32,resultX,resultY,distance);
-			}
+/****************************************************
+*****ROUND: HOSTED PLAYERS
+*****each player rank plays several players as threads. it sends all their messages to the ball owner
+*****and all their info to fp0 in one message each, then the owner sends the result to every other rank
+***************************************************/
+void hostedRound(struct matchState * s){
+	int rank = s->rank;
+	int n = s->hosted;
+	int hosts = PLAYERS / n;
+	int numtasks = s->fieldCount + hosts;
+	int owner = s->tileCols ? fieldTile(s->ballCoords, s->tileCols, s->tileRows) : fieldProcess(s->ballCoords);
+	MPI_Request reqs[2*MAX_PLAYERS];
+	long long t;
+	int i;
+	
+	if(rank >= s->fieldCount){
+		t = probeStart(&s->prof);
+		hostMove(&s->host, s->round, s->ballCoords);
+		probeEnd(&s->prof, PHASE_MOVE, t);
+		for(i = 0; i < n; i++)
+			statsMove(&s->stats, s->id+i, s->host.playerInfo+i*PLYR_INFO_SIZE);
+		MPI_Isend(s->host.playerMessage, n*PLYR_MSG_SIZE, MPI_INT, owner, MESSAGE_TAG, s->comm, &reqs[0]);
+		reqs[1] = MPI_REQUEST_NULL;
+		if(s->needInfo)
+			MPI_Isend(s->host.playerInfo, n*PLYR_INFO_SIZE, MPI_INT, FP0, INFO_TAG, s->comm, &reqs[1]);
+		t = probeStart(&s->prof);
+		MPI_Recv(s->ballChallengeInfo, 7, MPI_INT, owner, BALL_CHALLENGE_TAG, s->comm, MPI_STATUS_IGNORE);
+		probeEnd(&s->prof, PHASE_CHALLENGE, t);
+		t = probeStart(&s->prof);
+		MPI_Waitall(2, reqs, MPI_STATUSES_IGNORE);
+		probeEnd(&s->prof, PHASE_SEND, t);
+		s->ballCoords[X] = s->ballChallengeInfo[3];
+		s->ballCoords[Y] = s->ballChallengeInfo[4];
+		return;
+	}
+	
+	//player ids are contiguous per host, so each host's block lands straight in its slots
+	if(rank == FP0){
+		outputRoundStart(s);
+		for(i = 0; i < hosts; i++){
+			reqs[PLAYERS+i] = MPI_REQUEST_NULL;
+			if(s->needInfo)
+				MPI_Irecv(s->allPlayerInfo+(i*n+2)*PLYR_INFO_SIZE, n*PLYR_INFO_SIZE, MPI_INT, s->fieldCount+i, INFO_TAG, s->comm, &reqs[PLAYERS+i]);
+		}
+	}
+	
+	if(rank == owner){
+		MPI_Request * sends = malloc((numtasks-1)*sizeof(MPI_Request));
+		int m = 0;
+		for(i = 0; i < hosts; i++)
+			MPI_Irecv(s->playerMessage+(i*n+2)*PLYR_MSG_SIZE, n*PLYR_MSG_SIZE, MPI_INT, s->fieldCount+i, MESSAGE_TAG, s->comm, &reqs[i]);
+		t = probeStart(&s->prof);
+		MPI_Waitall(hosts, reqs, MPI_STATUSES_IGNORE);
+		probeEnd(&s->prof, PHASE_MSG, t);
+		resolveChallenge(s);
+		for(i = 0; i < numtasks; i++){
+			if(i != rank)
+				MPI_Isend(s->ballChallengeInfo, 7, MPI_INT, i, BALL_CHALLENGE_TAG, s->comm, &sends[m++]);
 		}
-		else{	//attack left side
-			if(currX < 108 || abs(currY - 32) > 16)
-				run(128,32,resultX,resultY,distance);
+		if(rank == FP0){
+			t = probeStart(&s->prof);
+			MPI_Waitall(hosts, &reqs[PLAYERS], MPI_STATUSES_IGNORE);
+			probeEnd(&s->prof, PHASE_INFO, t);
+			applyBallChallenge(s);
+			outputRoundEnd(s);
 		}
+		MPI_Waitall(m, sends, MPI_STATUSES_IGNORE);
+		free(sends);
 	}
 	else{
-		if(rank < 7){	//attack left side
-			if(currX < 108 || abs(currY -32) > 16)
-				run(128,32,resultX,resultY,distance);
-		}
-		else{
-			if(currX > 20 || abs(currY - 32) > 16)
-				run(0,32,resultX,resultY,distance);		
+		t = probeStart(&s->prof);
+		MPI_Recv(s->ballChallengeInfo, 7, MPI_INT, owner, BALL_CHALLENGE_TAG, s->comm, MPI_STATUS_IGNORE);
+		probeEnd(&s->prof, PHASE_CHALLENGE, t);
+		s->ballCoords[X] = s->ballChallengeInfo[3];
+		s->ballCoords[Y] = s->ballChallengeInfo[4];
+		if(rank == FP0){
+			t = probeStart(&s->prof);
+			MPI_Waitall(hosts, &reqs[PLAYERS], MPI_STATUSES_IGNORE);
+			probeEnd(&s->prof, PHASE_INFO, t);
+			applyBallChallenge(s);
+			outputRoundEnd(s);
 		}
 	}
 }
 
-int inMyField(int * location){
-	return *location <= 64 ? FP0 : FP1;
+//player's move for the round, fills in playerMessage. returns 1 if the player reached the ball
+int playerMove(struct matchState * s){
+	struct rngStream rng;
+	long long t = probeStart(&s->prof);
+	rngStart(&rng, s->seed, s->match, s->round, s->id);
+	int reached = playerTurn(s->id, s->round, s->ballCoords, s->playerInfo, &s->target, s->speed, s->dribbling, s->shooting, s->playerMessage, &rng);
+	probeEnd(&s->prof, PHASE_MOVE, t);
+	statsMove(&s->stats, s->id, s->playerInfo);
+	return reached;
 }
 
-void determineShot(int shootSkill, int * ballCoords, int * shotCoords, int * output){
-	//get shot probability
-	int distance = abs(*ballCoords-*shotCoords) + abs((*ballCoords+1)-(*shotCoords+1));
-	float probability = getShotProbability(distance, shootSkill);
-	//get rand() if good shot, set output and return
-	float shotProb = (float)rand()/(float)RAND_MAX;
-	if(shotProb <= probability){
-		*output = *shotCoords;
-		*(output+1) = *(shotCoords+1);
+//sends a player's message for the round to the field process that owns the ball, and to the other one as a dummy
+//in its own buffer, since the real one is still in flight. replicated field processes both get the real one
+void p2pSend(struct matchState * s, int * message, int * dummy, int reached, int tag, MPI_Request * reqs){
+	int * other = message;
+	int fp = fieldProcess(s->ballCoords);
+	MPI_Isend(message, PLYR_MSG_SIZE, MPI_INT, fp, tag, s->comm, &reqs[0]);
+	if(reached && !s->replicate){
+		memcpy(dummy, message, PLYR_MSG_SIZE*sizeof(int));
+		dummy[X] = -1;
+		other = dummy;
 	}
-	else{
-		int ranLocation = (rand() % 8) + 1;
-		int minus = rand() % 2;
-		*output = *shotCoords + (ranLocation/2 * (minus==0?-1:1));
-		minus = rand() % 2;
-		*(output+1) = *(shotCoords+1) + (ranLocation/2 * (minus==0?-1:1));
-		
-		//check for bounds
-		if(*output > 128){
-			*output = 108;
-		} else if(*output < 0){
-			*output = 20;
-		}
-		
-		if(*(output+1) > 64){
-			*(output+1) = 64;
-		} else if(*(output+1) < 0){
-			*(output+1) = 0;
-		}
+	MPI_Isend(other, PLYR_MSG_SIZE, MPI_INT, fp == FP0 ? FP1 : FP0, tag, s->comm, &reqs[1]);
+}
+
+//--speculate: the player's next move, for the ball where it is now, made and sent at the end of its round. the
+//draws are keyed by the next round, so it is the same move the player makes if the ball stays
+void specMove(struct matchState * s){
+	struct speculation * p = &s->spec;
+	struct rngStream rng;
+	MPI_Waitall(2, p->sends, MPI_STATUSES_IGNORE);		//the guess for this round, received by now
+	p->pending = s->round+1 < s->rounds;
+	if(!p->pending)
+		return;
+	long long before = wall_clock_time();
+	long long t = probeStart(&s->prof);
+	memcpy(p->info, s->playerInfo, sizeof(p->info));
+	p->target = s->target;
+	p->ball[X] = s->ballCoords[X];
+	p->ball[Y] = s->ballCoords[Y];
+	rngStart(&rng, s->seed, s->match, s->round+1, s->id);
+	int reached = playerTurn(s->id, s->round+1, p->ball, p->info, &p->target, s->speed, s->dribbling, s->shooting, p->message, &rng);
+	probeEnd(&s->prof, PHASE_MOVE, t);
+	p->moveNs = wall_clock_time() - before;
+	p2pSend(s, p->message, p->dummy, reached, MESSAGE_TAG, p->sends);
+}
+
+//--speculate: the ball stayed, so the move sent last round becomes the player's state
+void specCommit(struct matchState * s){
+	memcpy(s->playerInfo, s->spec.info, sizeof(s->spec.info));
+	s->target = s->spec.target;
+	s->spec.usedNs += s->spec.moveNs;
+	statsMove(&s->stats, s->id, s->playerInfo);
+}
+
+//--speculate: fp0 reports how often the guess was right, and its wait for the player messages when it was and
+//when it was not, which is about what each right guess saved. collective over the match
+void specReport(struct matchState * s, FILE * out){
+	struct speculation * p = &s->spec;
+	long long mine[2] = {p->usedNs, p->redoneNs}, sum[2];
+	MPI_Reduce(mine, sum, 2, MPI_LONG_LONG, MPI_SUM, FP0, s->comm);
+	if(s->rank != FP0 || p->hits + p->misses == 0)
+		return;
+	double hitWait = p->hits ? (double)p->hitWaitNs/1000/p->hits : 0;
+	double missWait = p->misses ? (double)p->missWaitNs/1000/p->misses : 0;
+	fprintf(out, "speculation: %d of %d rounds hit (%1.1f%%), fp0 waited for the player messages %1.2f usec on a hit and %1.2f usec on a miss, about %1.5f sec saved\n",
+		p->hits, p->hits + p->misses, 100.0*p->hits/(p->hits + p->misses), hitWait, missWait, p->hits*(missWait - hitWait)/1000000);
+	fprintf(out, "speculation: players moved ahead of the ball for %1.5f sec that stood and %1.5f sec that was redone\n",
+		(double)sum[0]/1000000000, (double)sum[1]/1000000000);
+}
+
+//field process with the ball resolves the challenge. its draws are keyed as fp0's, whichever field process owns the ball
+void resolveChallenge(struct matchState * s){
+	struct rngStream rng;
+	int owner = fieldProcess(s->ballCoords);
+	long long t = probeStart(&s->prof);
+	rngStart(&rng, s->seed, s->match, s->round, FP0);
+	resolveBallChallenge(s->round, s->playerMessage, s->ballCoords, s->ballChallengeInfo, &rng);
+	probeEnd(&s->prof, PHASE_RESOLVE, t);
+	if(!s->replicate || s->rank == owner)		//replicas count each challenge once
+		statsChallenge(&s->stats, s->playerMessage, s->ballChallengeInfo);
+}
+
+//--check-replicas: fp1 sends the challenge result it resolved, fp0 compares it with its own
+void replicaCheck(struct matchState * s, MPI_Request * send){
+	int other[7];
+	if(s->rank == FP1){
+		MPI_Isend(s->ballChallengeInfo, 7, MPI_INT, FP0, BALL_CHALLENGE_TAG, s->comm, send);
+		return;
+	}
+	MPI_Recv(other, 7, MPI_INT, FP1, BALL_CHALLENGE_TAG, s->comm, MPI_STATUS_IGNORE);
+	if(memcmp(other, s->ballChallengeInfo, sizeof(other)) != 0){
+		if(s->replicaDiff < 0)
+			s->replicaDiff = s->round;
+		s->replicaDiffs++;
 	}
 }
 
-float getShotProbability(int d, int s){
-	float ratio = (10.0+90.0*s)/(0.5*d*pow(d,0.5)-0.5);
-	return ratio < 100 ? ratio/100.0 : 1;
+//fp0 sets the newly synced ball challenge information
+void applyBallChallenge(struct matchState * s){
+	int * ballChallengeInfo = s->ballChallengeInfo;
+	if(ballChallengeInfo[0] > 0){		//-1 if there were no challenges this round
+		s->score[ballChallengeInfo[6]] += ballChallengeInfo[5];
+		*(s->allPlayerInfo+(ballChallengeInfo[0]*9 + SHOOT_X)) = ballChallengeInfo[1];
+		*(s->allPlayerInfo+(ballChallengeInfo[0]*9 + SHOOT_Y)) = ballChallengeInfo[2];
+		*(s->allPlayerInfo+(ballChallengeInfo[0]*9 + WIN_RND)) = 1;
+	}
+	s->ballCoords[X] = ballChallengeInfo[3];
+	s->ballCoords[Y] = ballChallengeInfo[4];
 }
 
-int runTowardsBall(int ballX, int ballY, int currX, int currY, int *resultX, int *resultY, int distance){
-	int offsetX = ballX - currX;
-	int offsetY = ballY - currY;
-	int distFromBall = abs(offsetX) + abs(offsetY);
-	
-	if(distance >= distFromBall){
-		*resultX = ballX;
-		*resultY = ballY;
-		return distFromBall;
+//fp0 notes the score and ball the round starts with
+void outputRoundStart(struct matchState * s){
+	if(s->output == OUTPUT_SCORE)
+		return;
+	s->record.round = s->round;
+	s->record.score[0] = s->score[0];
+	s->record.score[1] = s->score[1];
+	s->record.ballCoords[X] = s->ballCoords[X];
+	s->record.ballCoords[Y] = s->ballCoords[Y];
+}
+
+//fp0 has every player's info for the round: print it, append it to the binary trace, or hand it to the writer thread
+void outputRoundEnd(struct matchState * s){
+	if(s->output == OUTPUT_SCORE)
+		return;
+	memcpy(s->record.playerInfo, s->allPlayerInfo+2*PLYR_INFO_SIZE, sizeof(s->record.playerInfo));
+	if(s->replaying)
+		replayCheck(s);
+	long long t = probeStart(&s->prof);
+	if(s->async)
+		writerPush(&s->writer, &s->record);
+	else if(s->output == OUTPUT_BINARY)
+		traceAppend(&s->trace, &s->record);
+	else if(s->output == OUTPUT_TEXT)
+		tracePrintRound(stdout, &s->record);
+	probeEnd(&s->prof, PHASE_OUTPUT, t);
+}
+
+//fp0 compares the round it just played with the same round of the recorded trace
+void replayCheck(struct matchState * s){
+	struct traceRound recorded;
+	if(s->replayDiff >= 0)
+		return;
+	if(!traceNext(&s->replay, &recorded) || memcmp(&recorded, &s->record, offsetof(struct traceRound, playerInfo) + PLAYERS*PLYR_INFO_SIZE*sizeof(int)) != 0)
+		s->replayDiff = s->round;
+}
+
+//collective over comm: its rank 0 prints the peak resident set of every rank on stderr
+void reportPeakRss(MPI_Comm comm){
+	struct rusage usage;
+	long rss, * all = NULL;
+	int rank, numtasks, i;
+	MPI_Comm_rank(comm, &rank);
+	MPI_Comm_size(comm, &numtasks);
+	getrusage(RUSAGE_SELF, &usage);
+	rss = usage.ru_maxrss;
+	if(rank == FP0)
+		all = malloc(numtasks*sizeof(long));
+	MPI_Gather(&rss, 1, MPI_LONG, all, 1, MPI_LONG, FP0, comm);
+	if(rank == FP0){
+		fprintf(stderr, "peak rss kB:");
+		for(i = 0; i < numtasks; i++)
+			fprintf(stderr, " %ld", all[i]);
+		fprintf(stderr, "\n");
+		free(all);
 	}
-	else{
-		run(ballX, ballY, resultX, resultY, distance);
-		return distance;
-	}	
 }
 
-//Precondition: distance will not reach destX and destY
-void run(int destX, int destY, int *currX, int *currY, int distance){
-	if(distance == 0)
-		return;	
-	else if(*currX == destX){
-		*currY = (*currY > destY) ? *currY - 1 : *currY + 1;
-		run(destX, destY, currX, currY, distance-1);
+//collective over MPI_COMM_WORLD after an ensemble: rank 0 prints every match's final score,
+//then the totals reduced over all matches
+void ensembleReport(struct matchState * s, int worldRank){
+	int numtasks, i;
+	int mine[2] = {-1, -1};
+	int * all = NULL;
+	long long stats[6] = {0}, total[6];	//matches, team a wins, team b wins, draws, team a points, team b points
+	MPI_Comm_size(MPI_COMM_WORLD, &numtasks);
+	if(s->rank == FP0){
+		mine[0] = s->score[0];
+		mine[1] = s->score[1];
+		stats[0] = 1;
+		stats[1] = s->score[0] > s->score[1];
+		stats[2] = s->score[1] > s->score[0];
+		stats[3] = s->score[0] == s->score[1];
+		stats[4] = s->score[0];
+		stats[5] = s->score[1];
 	}
-	else if(*currY == destY){
-		*currX = (*currX > destX) ? *currX - 1 : *currX + 1;
-		run(destX, destY, currX, currY, distance-1);
+	MPI_Reduce(stats, total, 6, MPI_LONG_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+	if(worldRank == 0)
+		all = malloc(2*numtasks*sizeof(int));
+	MPI_Gather(mine, 2, MPI_INT, all, 2, MPI_INT, 0, MPI_COMM_WORLD);
+	if(worldRank != 0)
+		return;
+	
+	int match = 0;
+	for(i = 0; i < numtasks; i++){
+		if(all[2*i] >= 0)
+			printf("%d %d %d\n", match++, all[2*i], all[2*i+1]);
 	}
-	else{
-		if(distance == 1){
-			*currX = (*currX > destX) ? *currX - 1 : *currX + 1;
-			return;
+	printf("%lld matches: team a won %lld, team b won %lld, %lld drawn, mean score %1.1f %1.1f\n", total[0], total[1], total[2], total[3],
+		(double)total[4]/total[0], (double)total[5]/total[0]);
+	free(all);
+}
+
+//collective over comm: snapshot what every rank carries into the next round
+void checkpointSave(struct matchState * s){
+	struct ckptHeader h;
+	struct ckptPlayer players[MAX_PLAYERS];
+	int count = 0, i;
+	long long before = wall_clock_time();
+	if(s->rank == FP0){
+		h.seed = s->seed;
+		h.match = s->match;
+		h.score[0] = s->score[0];
+		h.score[1] = s->score[1];
+		h.ballCoords[X] = s->ballCoords[X];
+		h.ballCoords[Y] = s->ballCoords[Y];
+	}
+	if(s->rank >= s->fieldCount && s->hosted){
+		struct playerHost * host = &s->host;
+		for(i = 0; i < host->players; i++){
+			players[i].id = host->firstId + i;
+			memcpy(players[i].playerInfo, host->playerInfo+i*PLYR_INFO_SIZE, sizeof(players[i].playerInfo));
+			players[i].target = host->target[i];
+			players[i].speed = host->speed[i];
+			players[i].dribbling = host->dribbling[i];
+			players[i].shooting = host->shooting[i];
 		}
-		*currX = (*currX > destX) ? *currX - 1 : *currX + 1;
-		*currY = (*currY > destY) ? *currY - 1 : *currY + 1;
-		run(destX, destY, currX, currY, distance-2);
+		count = host->players;
+	}
+	else if(s->rank >= s->fieldCount){
+		players[0].id = s->id;
+		memcpy(players[0].playerInfo, s->playerInfo, sizeof(players[0].playerInfo));
+		players[0].target = s->target;
+		players[0].speed = s->speed;
+		players[0].dribbling = s->dribbling;
+		players[0].shooting = s->shooting;
+		count = 1;
 	}
+	if(checkpointWrite(&s->checkpoint, s->round+1, s->rank == FP0 ? &h : NULL, players, count)){
+		printf("cannot write checkpoint. exiting..\n");
+		MPI_Abort(MPI_COMM_WORLD, 1);
+	}
+	long long spent = wall_clock_time() - before;
+	s->checkpoints++;
+	s->checkpointNs += spent;
+	if(spent > s->checkpointMaxNs)
+		s->checkpointMaxNs = spent;
 }
 
-int fieldProcess(int * coords){
-	return (*coords <= 64) ? FP0 : FP1;
+//puts a rank back where the checkpoint left it. every rank takes the ball and score from the header,
+//players overwrite what initPlayer set up
+void checkpointRestore(struct matchState * s, struct ckptHeader * h, struct ckptPlayer * players){
+	int i;
+	s->score[0] = h->score[0];
+	s->score[1] = h->score[1];
+	s->ballCoords[X] = h->ballCoords[X];
+	s->ballCoords[Y] = h->ballCoords[Y];
+	if(s->rank >= s->fieldCount && s->hosted){
+		struct playerHost * host = &s->host;
+		for(i = 0; i < host->players; i++){
+			memcpy(host->playerInfo+i*PLYR_INFO_SIZE, players[i].playerInfo, sizeof(players[i].playerInfo));
+			host->target[i] = players[i].target;
+			host->speed[i] = players[i].speed;
+			host->dribbling[i] = players[i].dribbling;
+			host->shooting[i] = players[i].shooting;
+		}
+	}
+	else if(s->rank >= s->fieldCount){
+		memcpy(s->playerInfo, players[0].playerInfo, sizeof(s->playerInfo));
+		s->target = players[0].target;
+		s->speed = players[0].speed;
+		s->dribbling = players[0].dribbling;
+		s->shooting = players[0].shooting;
+	}
 }
-
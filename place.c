@@ -0,0 +1,145 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <sched.h>
+#include "game.h"
+#include "place.h"
+
+//package of the cpu this process runs on, -1 if the system does not say
+static int socketOf(void){
+	char path[128];
+	int cpu = sched_getcpu(), socket = -1;
+	FILE * f;
+	if(cpu < 0)
+		return -1;
+	snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/physical_package_id", cpu);
+	f = fopen(path, "r");
+	if(f == NULL)
+		return -1;
+	if(fscanf(f, "%d", &socket) != 1)
+		socket = -1;
+	fclose(f);
+	return socket;
+}
+
+//node and socket of every rank of comm, as pairs in rank order
+static void locate(MPI_Comm comm, int * where){
+	MPI_Comm node;
+	int rank, mine[2];
+	MPI_Comm_rank(comm, &rank);
+	MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &node);
+	MPI_Allreduce(&rank, &mine[0], 1, MPI_INT, MPI_MIN, node);		//a node is known by its lowest rank
+	MPI_Comm_free(&node);
+	mine[1] = socketOf();
+	MPI_Allgather(mine, 2, MPI_INT, where, 2, MPI_INT, comm);
+}
+
+//ints a round moves between field process f and player rank p hosting perRank players: the message, real
+//or dummy, and for fp0 also the ball and the players' info
+static int weight(int f, int perRank){
+	int w = PLYR_MSG_SIZE*perRank;
+	if(f == FP0)
+		w += 2 + PLYR_INFO_SIZE*perRank;
+	return w;
+}
+
+static int * sortWhere;
+static int homeNode, homeSocket;
+
+static int placeClass(int r){
+	if(sortWhere[2*r] != homeNode)
+		return 2;
+	return sortWhere[2*r+1] == homeSocket ? 0 : 1;
+}
+
+//the home socket first, then the rest of its node, then the other nodes, each in old rank order
+static int placeCompare(const void * a, const void * b){
+	int ra = *(const int *)a, rb = *(const int *)b;
+	int ca = placeClass(ra), cb = placeClass(rb);
+	if(ca != cb)
+		return ca - cb;
+	if(sortWhere[2*ra] != sortWhere[2*rb])
+		return sortWhere[2*ra] - sortWhere[2*rb];
+	if(sortWhere[2*ra+1] != sortWhere[2*rb+1])
+		return sortWhere[2*ra+1] - sortWhere[2*rb+1];
+	return ra - rb;
+}
+
+//renumbers comm into *out for a match with fieldCount field processes and perRank players per player rank.
+//collective over comm
+void placeRanks(MPI_Comm comm, int fieldCount, int perRank, MPI_Comm * out, struct placement * p){
+	int rank, size, i, n = 0, newRank, moved;
+	MPI_Comm_rank(comm, &rank);
+	MPI_Comm_size(comm, &size);
+	int * neighbors = malloc(size*sizeof(int));
+	int * weights = malloc(size*sizeof(int));
+	int * where = malloc(2*size*sizeof(int));
+	int * order = malloc(size*sizeof(int));
+
+	//every player rank talks to every field process, and the field processes to each other
+	for(i = 0; i < size; i++){
+		if(i == rank || (rank >= fieldCount && i >= fieldCount))
+			continue;
+		neighbors[n] = i;
+		if(rank < fieldCount && i < fieldCount)
+			weights[n++] = 7;		//challenge result
+		else
+			weights[n++] = weight(rank < fieldCount ? rank : i, perRank);
+	}
+	MPI_Dist_graph_create_adjacent(comm, n, neighbors, weights, n, neighbors, weights, MPI_INFO_NULL, 1, out);
+	MPI_Comm_rank(*out, &newRank);
+	moved = newRank != rank;
+	MPI_Allreduce(MPI_IN_PLACE, &moved, 1, MPI_INT, MPI_SUM, comm);
+	p->how = PLACE_GRAPH;
+
+	if(moved == 0){
+		MPI_Comm_free(out);
+		locate(comm, where);
+		int best = 0, bestCount = 0;
+		for(i = 0; i < size; i++){
+			int j, count = 0;
+			for(j = 0; j < size; j++)
+				count += where[2*j] == where[2*i] && where[2*j+1] == where[2*i+1];
+			if(count > bestCount){
+				best = i;
+				bestCount = count;
+			}
+		}
+		homeNode = where[2*best];
+		homeSocket = where[2*best+1];
+		sortWhere = where;
+		for(i = 0; i < size; i++)
+			order[i] = i;
+		qsort(order, size, sizeof(int), placeCompare);
+		for(i = 0; i < size; i++){
+			if(order[i] == rank)
+				newRank = i;
+			moved += order[i] != i;
+		}
+		MPI_Comm_split(comm, 0, newRank, out);
+		p->how = moved ? PLACE_LOCALITY : PLACE_UNCHANGED;
+	}
+	p->moved = moved;
+	p->size = size;
+
+	//what fp0 ended up next to
+	int fp0[2];
+	locate(*out, where);
+	fp0[0] = where[0];
+	fp0[1] = where[1];
+	p->fieldNode = p->fieldSocket = 0;
+	for(i = 0; i < size; i++){
+		p->fieldNode += where[2*i] == fp0[0];
+		p->fieldSocket += where[2*i] == fp0[0] && where[2*i+1] == fp0[1];
+	}
+	free(neighbors);
+	free(weights);
+	free(where);
+	free(order);
+}
+
+void placeReport(struct placement * p, FILE * out){
+	const char * how = p->how == PLACE_GRAPH ? "graph reorder" : p->how == PLACE_LOCALITY ? "locality mapping" : "unchanged";
+	fprintf(out, "placement: %s, %d of %d ranks moved, fp0's socket holds %d ranks, its node %d\n",
+		how, p->moved, p->size, p->fieldSocket, p->fieldNode);
+}
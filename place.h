@@ -0,0 +1,27 @@
+#ifndef PLACE_H
+#define PLACE_H
+
+#include <stdio.h>
+#include <mpi.h>
+
+//--reorder: ranks take their role (field process, or the players they host) from their rank, so renumbering the
+//match communicator before any role is set moves roles between processes. the round's traffic is described as a
+//weighted graph for the mpi runtime to map. if that leaves every rank where it was, ranks are renumbered by
+//locality instead: the field processes go to the socket holding most of the match's ranks, and the players
+//follow in id order, so each team fills a socket, then a node, before spilling over
+#define PLACE_UNCHANGED 0
+#define PLACE_GRAPH 1		//the runtime renumbered from the graph
+#define PLACE_LOCALITY 2
+
+struct placement{
+	int how;
+	int moved;		//ranks whose role changed
+	int fieldSocket;	//ranks on fp0's socket, fp0 included
+	int fieldNode;		//ranks on fp0's node
+	int size;
+};
+
+void placeRanks(MPI_Comm, int, int, MPI_Comm *, struct placement *);
+void placeReport(struct placement *, FILE *);
+
+#endif
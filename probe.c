@@ -0,0 +1,122 @@
+#include <string.h>
+#include <time.h>
+#include "probe.h"
+
+static const char * phaseNames[PHASES] = {"move", "ball wait", "send wait", "msg wait", "resolve", "challenge wait", "info wait", "output", "round"};
+
+static long long probeNow(){
+	struct timespec tp;
+	clock_gettime(CLOCK_MONOTONIC, &tp);
+	return (long long)(tp.tv_nsec + (long long)tp.tv_sec * 1000000000ll);
+}
+
+//exact below 2*PROBE_SUB ns, then PROBE_SUB buckets per power of two (at most 25% wide)
+static int probeBucket(long long ns){
+	if(ns < 2*PROBE_SUB)
+		return (int)ns;
+	int e = 63 - __builtin_clzll((unsigned long long)ns);
+	int b = (e-1)*PROBE_SUB + (int)((ns >> (e-2)) & (PROBE_SUB-1));
+	return b < PROBE_BUCKETS ? b : PROBE_BUCKETS-1;
+}
+
+//smallest value that falls in the bucket after b, so percentiles are reported as upper bounds
+static long long probeBucketTop(int b){
+	if(b < 2*PROBE_SUB)
+		return b+1;
+	int e = b/PROBE_SUB + 1;
+	return (long long)(PROBE_SUB + b%PROBE_SUB + 1) << (e-2);
+}
+
+static void probeFold(struct probe * p, int slots){
+	int i, f;
+	for(i = 0; i < slots; i++){
+		for(f = 0; f < PHASES; f++){
+			if(!(p->seen[i] & (1 << f)))
+				continue;
+			long long ns = p->ring[i][f];
+			p->hist[f][probeBucket(ns)]++;
+			p->total[f] += ns;
+			if(ns > p->max[f])
+				p->max[f] = ns;
+		}
+	}
+}
+
+void probeInit(struct probe * p, int enabled){
+	memset(p, 0, sizeof(*p));
+	p->enabled = enabled;
+	p->slot = -1;
+}
+
+//called at the start of every round
+void probeRound(struct probe * p){
+	if(!p->enabled)
+		return;
+	if(++p->slot == PROBE_RING){
+		probeFold(p, PROBE_RING);
+		p->slot = 0;
+	}
+	memset(p->ring[p->slot], 0, sizeof(p->ring[p->slot]));
+	p->seen[p->slot] = 0;
+}
+
+long long probeStart(struct probe * p){
+	return p->enabled ? probeNow() : 0;
+}
+
+void probeEnd(struct probe * p, int phase, long long start){
+	if(!p->enabled)
+		return;
+	p->ring[p->slot][phase] += probeNow() - start;
+	p->seen[p->slot] |= 1 << phase;
+}
+
+//time the current round spent waiting, over all the wait phases
+long long probeWaitNs(struct probe * p){
+	if(!p->enabled)
+		return 0;
+	long long * ring = p->ring[p->slot];
+	return ring[PHASE_BALL] + ring[PHASE_SEND] + ring[PHASE_MSG] + ring[PHASE_CHALLENGE] + ring[PHASE_INFO];
+}
+
+static long long probePercentile(long long * hist, long long count, double q){
+	long long want = (long long)(q*count), seen = 0;
+	int b;
+	if(want >= count)
+		want = count-1;
+	for(b = 0; b < PROBE_BUCKETS; b++){
+		seen += hist[b];
+		if(seen > want)
+			return probeBucketTop(b);
+	}
+	return probeBucketTop(PROBE_BUCKETS-1);
+}
+
+//collective over comm: sums every rank's histograms on root, which prints one line per phase
+void probeReport(struct probe * p, MPI_Comm comm, int root, FILE * out){
+	static long long hist[PHASES][PROBE_BUCKETS];
+	long long total[PHASES], max[PHASES];
+	int rank, f, b;
+	if(!p->enabled)
+		return;
+	probeFold(p, p->slot+1);
+	p->slot = -1;
+	MPI_Comm_rank(comm, &rank);
+	MPI_Reduce(p->hist, hist, PHASES*PROBE_BUCKETS, MPI_LONG_LONG, MPI_SUM, root, comm);
+	MPI_Reduce(p->total, total, PHASES, MPI_LONG_LONG, MPI_SUM, root, comm);
+	MPI_Reduce(p->max, max, PHASES, MPI_LONG_LONG, MPI_MAX, root, comm);
+	if(rank != root)
+		return;
+	
+	fprintf(out, "%-15s %9s %10s %9s %9s %9s %9s %9s\n", "phase", "samples", "total ms", "mean us", "p50 us", "p90 us", "p99 us", "max us");
+	for(f = 0; f < PHASES; f++){
+		long long count = 0;
+		for(b = 0; b < PROBE_BUCKETS; b++)
+			count += hist[f][b];
+		if(count == 0)
+			continue;
+		fprintf(out, "%-15s %9lld %10.3f %9.2f %9.2f %9.2f %9.2f %9.2f\n", phaseNames[f], count, total[f]/1e6, total[f]/1e3/count,
+			probePercentile(hist[f], count, 0.5)/1e3, probePercentile(hist[f], count, 0.9)/1e3,
+			probePercentile(hist[f], count, 0.99)/1e3, max[f]/1e3);
+	}
+}
@@ -0,0 +1,42 @@
+#ifndef PROBE_H
+#define PROBE_H
+
+#include <stdio.h>
+#include <mpi.h>
+
+//per-rank round phase timing (--profile). probes add the time spent in a phase to the current
+//round's slot of a ring; every PROBE_RING rounds the ring is folded into one log-linear histogram
+//per phase, and at the end the histograms of all ranks are summed on fp0 for the percentiles
+#define PROBE_RING 256
+#define PROBE_SUB 4			//buckets per power of two
+#define PROBE_BUCKETS 256
+
+#define PHASE_MOVE 0		//players: runStrategy and the message
+#define PHASE_BALL 1		//players: waiting for the ball coordinates
+#define PHASE_SEND 2		//players: waiting for their sends to complete
+#define PHASE_MSG 3		//field: waiting for the player messages
+#define PHASE_RESOLVE 4		//field: challenge resolution
+#define PHASE_CHALLENGE 5	//waiting for the challenge result from the ball owner
+#define PHASE_INFO 6		//fp0: waiting for the player info
+#define PHASE_OUTPUT 7		//fp0: printing, trace writing or handing the round to the writer
+#define PHASE_ROUND 8		//the whole round
+#define PHASES 9
+
+struct probe{
+	int enabled;
+	int slot;				//ring slot of the current round, -1 before the first
+	long long ring[PROBE_RING][PHASES];
+	int seen[PROBE_RING];			//bit per phase that was timed in the round
+	long long hist[PHASES][PROBE_BUCKETS];
+	long long total[PHASES];
+	long long max[PHASES];
+};
+
+void probeInit(struct probe *, int);
+void probeRound(struct probe *);
+long long probeStart(struct probe *);
+void probeEnd(struct probe *, int, long long);
+long long probeWaitNs(struct probe *);
+void probeReport(struct probe *, MPI_Comm, int, FILE *);
+
+#endif
@@ -0,0 +1,180 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "store.h"
+
+//ingests match traces into a replay store once, then answers queries over every match in it from the mapped
+//file: the ball wins of a player or a team, scoring rounds by points, and single rounds
+struct query{
+	int team;		//-1 for both
+	int player;		//within the team, -1 for all
+	int points;		//-1 for any
+	int from;
+	int to;
+	int match;		//-1 for every match
+	int count;		//print the number of hits only
+};
+
+static void usage(void){
+	printf("usage: replay_store add store [--roster file] trace ...\n"
+		"       replay_store list store\n"
+		"       replay_store wins store [--team a|b] [--player n] [--from r] [--to r] [--match m] [--count]\n"
+		"       replay_store scores store [--team a|b] [--points n] [--from r] [--to r] [--match m] [--count]\n"
+		"       replay_store round store match round\n");
+}
+
+//returns nonzero if the command line is not understood
+static int parseQuery(int argc, char *argv[], struct query * q){
+	int i;
+	q->team = q->player = q->points = q->match = -1;
+	q->from = 0;
+	q->to = 1 << 30;
+	q->count = 0;
+	for(i = 3; i < argc; i++){
+		if(strcmp(argv[i], "--team") == 0 && i+1 < argc){
+			i++;
+			if(strcmp(argv[i], "a") != 0 && strcmp(argv[i], "b") != 0)
+				return 1;
+			q->team = argv[i][0] - 'a';
+		}
+		else if(strcmp(argv[i], "--player") == 0 && i+1 < argc)
+			q->player = atoi(argv[++i]);
+		else if(strcmp(argv[i], "--points") == 0 && i+1 < argc)
+			q->points = atoi(argv[++i]);
+		else if(strcmp(argv[i], "--from") == 0 && i+1 < argc)
+			q->from = atoi(argv[++i]);
+		else if(strcmp(argv[i], "--to") == 0 && i+1 < argc)
+			q->to = atoi(argv[++i]);
+		else if(strcmp(argv[i], "--match") == 0 && i+1 < argc)
+			q->match = atoi(argv[++i]);
+		else if(strcmp(argv[i], "--count") == 0)
+			q->count = 1;
+		else
+			return 1;
+	}
+	return q->player < -1 || (q->player >= 0 && q->team < 0);
+}
+
+//prints the events of match m between the query's rounds that pass its filters, only those that scored if
+//scored is set. returns how many did
+static int queryEvents(struct store * s, struct query * q, int m, struct storeEvent * events, int n, int scored){
+	struct storeMatch * d = &s->directory[m];
+	int i, hits = 0;
+	for(i = storeFirstFrom(events, n, q->from); i < n && events[i].round <= q->to; i++){
+		int team = events[i].player < d->teamSize ? 0 : 1;
+		if((q->team >= 0 && team != q->team) || (q->points >= 0 && events[i].points != q->points) || (scored && events[i].points <= 0))
+			continue;
+		if(!q->count)
+			printf("%d %d %c %d %d\n", m, events[i].round, 'a'+team, events[i].player - team*d->teamSize, events[i].points);
+		hits++;
+	}
+	return hits;
+}
+
+int main(int argc, char *argv[]){
+	struct store s;
+	struct query q;
+	int m, hits = 0, matched = 0;
+	if(argc < 3){
+		usage();
+		return 1;
+	}
+
+	if(strcmp(argv[1], "add") == 0){
+		int first = 3;
+		if(argc > 4 && strcmp(argv[3], "--roster") == 0){		//for text traces
+			if(gameLoadRoster(argv[4]) != 0){
+				printf("cannot load roster %s\n", argv[4]);
+				return 1;
+			}
+			first = 5;
+		}
+		if(first >= argc){
+			usage();
+			return 1;
+		}
+		long long before = wall_clock_time();
+		int failed = storeAdd(argv[2], argv+first, argc-first);
+		if(failed == -2){
+			fprintf(stderr, "%s: cannot write the store, it is left as it was\n", argv[2]);
+			return 1;
+		}
+		if(failed < 0){
+			fprintf(stderr, "%s: not a replay store\n", argv[2]);
+			return 1;
+		}
+		if(failed > 0){
+			fprintf(stderr, "%s: not a match trace, the traces before it were added\n", argv[first+failed-1]);
+			return 1;
+		}
+		fprintf(stderr, "%d traces added in %1.3f sec\n", argc-first, (double)(wall_clock_time()-before)/1000000000);
+		return 0;
+	}
+
+	long long before = wall_clock_time();
+	if(storeOpen(&s, argv[2])){
+		fprintf(stderr, "%s: not a replay store\n", argv[2]);
+		return 1;
+	}
+	if(strcmp(argv[1], "list") == 0 && argc == 3){
+		for(m = 0; m < s.matches; m++){
+			struct storeMatch * d = &s.directory[m];
+			printf("%d %s seed %u, %d players, %d rounds, %d %d, %d wins, %d scoring\n", m, d->name, d->seed, d->players,
+				d->rounds, d->score[0], d->score[1], d->wins, d->scores);
+		}
+	}
+	else if(strcmp(argv[1], "round") == 0 && argc == 5){
+		struct traceRound r;
+		int round = atoi(argv[4]), lo = 0, hi;
+		m = atoi(argv[3]);
+		if(m < 0 || m >= s.matches){
+			fprintf(stderr, "no match %d\n", m);
+			storeClose(&s);
+			return 1;
+		}
+		for(hi = s.directory[m].rounds; lo < hi; ){		//records are in round order
+			int mid = (lo+hi)/2;
+			if(storeRecordAt(&s, m, mid)->round < round)
+				lo = mid+1;
+			else
+				hi = mid;
+		}
+		if(lo == s.directory[m].rounds || storeRecordAt(&s, m, lo)->round != round){
+			fprintf(stderr, "match %d has no round %d\n", m, round);
+			storeClose(&s);
+			return 1;
+		}
+		storeRoundOf(&s, m, storeRecordAt(&s, m, lo), &r);
+		game.players = s.directory[m].players;		//print with the match's own team split
+		game.teamSize = s.directory[m].teamSize;
+		tracePrintRound(stdout, &r);
+	}
+	else if((strcmp(argv[1], "wins") == 0 || strcmp(argv[1], "scores") == 0) && !parseQuery(argc, argv, &q)){
+		int scores = strcmp(argv[1], "scores") == 0;
+		for(m = q.match < 0 ? 0 : q.match; m < s.matches && (q.match < 0 || m == q.match); m++){
+			struct storeMatch * d = &s.directory[m];
+			struct storeEvent * events;
+			int n = scores ? d->scores : d->wins, found;
+			if(q.player >= 0){		//a player's scoring rounds are among its wins
+				if(q.player >= (q.team == 0 ? d->teamSize : d->players - d->teamSize))
+					continue;
+				events = storeWinsByPlayer(&s, m, q.team*d->teamSize + q.player, &n);
+			}
+			else
+				events = scores ? storeScores(&s, m) : storeWins(&s, m);
+			found = queryEvents(&s, &q, m, events, n, scores);
+			hits += found;
+			matched += found > 0;
+		}
+		if(q.count)
+			printf("%d\n", hits);
+		fprintf(stderr, "%d hits in %d of %d matches, %1.3f ms\n", hits, matched, s.matches, (double)(wall_clock_time()-before)/1000000);
+	}
+	else{
+		usage();
+		storeClose(&s);
+		return 1;
+	}
+	storeClose(&s);
+	return 0;
+}
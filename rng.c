@@ -0,0 +1,47 @@
+#include "rng.h"
+
+#define PHILOX_M0 0xD2511F53u
+#define PHILOX_M1 0xCD9E8D57u
+#define PHILOX_W0 0x9E3779B9u
+#define PHILOX_W1 0xBB67AE85u
+
+static void philox(unsigned int * ctr, unsigned int * key, unsigned int * out){
+	unsigned int c0 = ctr[0], c1 = ctr[1], c2 = ctr[2], c3 = ctr[3];
+	unsigned int k0 = key[0], k1 = key[1];
+	int i;
+	for(i = 0; i < 10; i++){
+		unsigned long long p0 = (unsigned long long)PHILOX_M0 * c0;
+		unsigned long long p1 = (unsigned long long)PHILOX_M1 * c2;
+		c0 = (unsigned int)(p1 >> 32) ^ c1 ^ k0;
+		c1 = (unsigned int)p1;
+		c2 = (unsigned int)(p0 >> 32) ^ c3 ^ k1;
+		c3 = (unsigned int)p0;
+		k0 += PHILOX_W0;
+		k1 += PHILOX_W1;
+	}
+	out[0] = c0;
+	out[1] = c1;
+	out[2] = c2;
+	out[3] = c3;
+}
+
+//the stream for one rank's draws in one round. the game rules know the field by rank FP0,
+//whichever process or engine actually resolves the challenge
+void rngStart(struct rngStream * s, unsigned int seed, int match, int round, int rank){
+	s->key[0] = seed;
+	s->key[1] = (unsigned int)match;
+	s->round = (unsigned int)round;
+	s->rank = (unsigned int)rank;
+	s->draw = 0;
+}
+
+//next draw in 0..RNG_MAX, a drop-in for rand()
+int rngNext(struct rngStream * s){
+	unsigned int i = s->draw & 3;
+	if(i == 0){
+		unsigned int ctr[4] = {s->round, s->rank, s->draw >> 2, 0};
+		philox(ctr, s->key, s->block);
+	}
+	s->draw++;
+	return (int)(s->block[i] >> 1);
+}
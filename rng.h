@@ -0,0 +1,21 @@
+#ifndef RNG_H
+#define RNG_H
+
+//counter-based random numbers (philox 4x32, 10 rounds). a draw is a pure function of
+//(seed, match, round, rank, draw index), so any match can be replayed exactly and every
+//engine, whatever order it plays matches and players in, sees the same numbers
+#define RNG_MAX 0x7fffffff
+
+//draws of one rank in one round of one match
+struct rngStream{
+	unsigned int key[2];		//seed, match
+	unsigned int round;
+	unsigned int rank;
+	unsigned int draw;		//next draw index
+	unsigned int block[4];		//philox output for draws draw&~3 .. draw|3
+};
+
+void rngStart(struct rngStream *, unsigned int, int, int, int);
+int rngNext(struct rngStream *);
+
+#endif
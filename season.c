@@ -0,0 +1,288 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <mpi.h>
+#include "game.h"
+#include "lockstep.h"
+#include "steal.h"
+
+//plays a season of fixtures, each a whole match under its own roster and seed, spread over the ranks and their
+//worker threads by work stealing. a fixture plays as match id i, its line number among the fixtures, so it is
+//the same as batch --seed s --roster file match i. fixtures of the same roster and length are dealt out in
+//groups that play in lockstep, so the vector kernel has matches to fill its lanes with
+#define SEASON_PATH 256
+#define SEASON_GROUP 8		//fixtures in a group at most, one avx2 step
+
+struct fixture{
+	int roster;		//index into the season's rosters
+	unsigned int seed;
+	int rounds;		//0 for the roster's
+};
+
+struct season{
+	int count;
+	int rosterCount;
+	struct fixture * fixtures;
+	struct gameConfig * rosters;
+	int * result;		//[f*3]: team a's points, team b's, worker that played it
+	int workerBase;		//this rank's first worker number
+	int groupCount;
+	int * groupStart;		//group g is fixtures member[groupStart[g]..groupStart[g+1]-1]
+	int * member;
+};
+
+int parseSeasonOptions(int, char **, char **, int *, int *, int *);
+int seasonLoad(struct season *, const char *);
+void seasonGroup(struct season *, int);
+void seasonPlay(int, int, void *);
+
+int main(int argc, char *argv[]){
+	char * path;
+	int threads, stealing, quiet, provided, rank, size, i;
+	struct season s;
+	MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	MPI_Comm_size(MPI_COMM_WORLD, &size);
+	if(parseSeasonOptions(argc, argv, &path, &threads, &stealing, &quiet)){
+		if(rank == 0)
+			printf("usage: season --fixtures file [--threads n] [--static] [--quiet]\n");
+		MPI_Finalize();
+		return 1;
+	}
+	if(provided < MPI_THREAD_FUNNELED){
+		if(rank == 0)
+			printf("warning: the mpi library has no thread support. exiting..\n");
+		MPI_Finalize();
+		return 1;
+	}
+
+	//rank 0 reads the fixtures and their rosters, every rank gets them as bytes
+	int line = rank == 0 ? seasonLoad(&s, path) : 0;
+	MPI_Bcast(&line, 1, MPI_INT, 0, MPI_COMM_WORLD);
+	if(line){
+		if(rank == 0)
+			printf("cannot load fixtures %s (line %d)\n", path, line);
+		MPI_Finalize();
+		return 1;
+	}
+	MPI_Bcast(&s.count, 1, MPI_INT, 0, MPI_COMM_WORLD);
+	MPI_Bcast(&s.rosterCount, 1, MPI_INT, 0, MPI_COMM_WORLD);
+	if(rank != 0){
+		s.fixtures = malloc(s.count*sizeof(struct fixture));
+		s.rosters = malloc(s.rosterCount*sizeof(struct gameConfig));
+	}
+	MPI_Bcast(s.fixtures, s.count*sizeof(struct fixture), MPI_BYTE, 0, MPI_COMM_WORLD);
+	MPI_Bcast(s.rosters, s.rosterCount*sizeof(struct gameConfig), MPI_BYTE, 0, MPI_COMM_WORLD);
+	s.result = calloc(3*s.count, sizeof(int));
+	s.workerBase = rank*threads;
+	seasonGroup(&s, size*threads);
+
+	struct stealPool pool;
+	if(stealRun(&pool, MPI_COMM_WORLD, threads, s.groupCount, stealing, seasonPlay, &s)){
+		printf("rank %d cannot start its workers\n", rank);
+		MPI_Abort(MPI_COMM_WORLD, 1);
+	}
+
+	//per worker: groups, groups stolen from siblings, busy ns. per rank: groups in and out, wall ns
+	long long * mine = malloc((3*threads+3)*sizeof(long long));
+	for(i = 0; i < threads; i++){
+		mine[3*i] = pool.worker[i].played;
+		mine[3*i+1] = pool.worker[i].stolen;
+		mine[3*i+2] = pool.worker[i].busyNs;
+	}
+	mine[3*threads] = pool.remoteIn;
+	mine[3*threads+1] = pool.remoteOut;
+	mine[3*threads+2] = pool.wallNs;
+	long long * all = rank == 0 ? malloc(size*(3*threads+3)*sizeof(long long)) : NULL;
+	MPI_Gather(mine, 3*threads+3, MPI_LONG_LONG, all, 3*threads+3, MPI_LONG_LONG, 0, MPI_COMM_WORLD);
+	MPI_Reduce(rank == 0 ? MPI_IN_PLACE : s.result, s.result, 3*s.count, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
+
+	if(rank == 0){
+		long long wall = 0;
+		int * matches = calloc(size*threads, sizeof(int));
+		int r;
+		for(r = 0; r < size; r++){
+			if(all[r*(3*threads+3)+3*threads+2] > wall)
+				wall = all[r*(3*threads+3)+3*threads+2];
+		}
+		for(i = 0; i < s.count; i++)
+			matches[s.result[3*i+2]]++;
+		if(!quiet){
+			for(i = 0; i < s.count; i++)
+				printf("%d %d %d %d\n", i, s.result[3*i], s.result[3*i+1], s.result[3*i+2]);
+		}
+		for(r = 0; r < size; r++){
+			long long * w = all + r*(3*threads+3);
+			for(i = 0; i < threads; i++)
+				printf("worker %d.%d: %d matches in %lld groups, %lld stolen from its rank, busy %1.5f sec, utilization %1.1f%%\n",
+					r, i, matches[r*threads+i], w[3*i], w[3*i+1], (double)w[3*i+2]/1000000000, 100.0*w[3*i+2]/wall);
+			printf("rank %d: %lld groups taken from other ranks, %lld given away\n", r, w[3*threads], w[3*threads+1]);
+		}
+		double sec = (double)wall/1000000000;
+		printf("%d fixtures in %d groups in %1.5f sec on %d workers (%d ranks x %d threads), %1.1f matches/sec, %s\n",
+			s.count, s.groupCount, sec, size*threads, size, threads, s.count/sec, stealing ? "work stealing" : "static split");
+		free(matches);
+		free(all);
+	}
+
+	stealFree(&pool);
+	free(mine);
+	free(s.fixtures);
+	free(s.rosters);
+	free(s.result);
+	free(s.groupStart);
+	free(s.member);
+	MPI_Finalize();
+	return 0;
+}
+
+//returns nonzero if the command line is not understood
+int parseSeasonOptions(int argc, char *argv[], char ** path, int * threads, int * stealing, int * quiet){
+	int i;
+	*path = NULL;
+	*threads = 1;
+	*stealing = 1;
+	*quiet = 0;
+	for(i = 1; i < argc; i++){
+		if(strcmp(argv[i], "--fixtures") == 0 && i+1 < argc)
+			*path = argv[++i];
+		else if(strcmp(argv[i], "--threads") == 0 && i+1 < argc){
+			*threads = atoi(argv[++i]);
+			if(*threads <= 0)
+				return 1;
+		}
+		else if(strcmp(argv[i], "--static") == 0)
+			*stealing = 0;
+		else if(strcmp(argv[i], "--quiet") == 0)
+			*quiet = 1;
+		else
+			return 1;
+	}
+	return *path == NULL;
+}
+
+//reads "roster seed [rounds]" lines, roster being a roster file or - for the built in game. a relative roster
+//path is taken from the directory of the fixtures file. each roster file is loaded once. a '#' starts a comment. returns 0, -1 if the file cannot be read, or the number of the first line
+//that is not understood or whose roster does not load
+int seasonLoad(struct season * s, const char * path){
+	char line[SEASON_PATH+64], file[SEASON_PATH], full[2*SEASON_PATH];
+	const char * slash = strrchr(path, '/');
+	char (*paths)[SEASON_PATH] = NULL;
+	struct gameConfig builtIn = game;
+	int n = 0, capacity = 0, rosterCapacity = 0, i;
+	FILE * f = fopen(path, "r");
+	if(f == NULL)
+		return -1;
+	s->count = s->rosterCount = 0;
+	s->fixtures = NULL;
+	s->rosters = NULL;
+	while(fgets(line, sizeof(line), f) != NULL){
+		struct fixture fx = {0, 0, 0};
+		char * hash = strchr(line, '#');
+		int fields;
+		n++;
+		if(hash != NULL)
+			*hash = '\0';
+		fields = sscanf(line, "%255s %u %d", file, &fx.seed, &fx.rounds);
+		if(fields <= 0)
+			continue;
+		if(fields < 2 || fx.rounds < 0){
+			fclose(f);
+			return n;
+		}
+		for(i = 0; i < s->rosterCount && strcmp(paths[i], file) != 0; i++)
+			;
+		if(i == s->rosterCount){
+			if(s->rosterCount == rosterCapacity){
+				rosterCapacity = rosterCapacity ? 2*rosterCapacity : 8;
+				paths = realloc(paths, rosterCapacity*sizeof(*paths));
+				s->rosters = realloc(s->rosters, rosterCapacity*sizeof(struct gameConfig));
+			}
+			game = builtIn;
+			if(file[0] != '/' && slash != NULL)
+				snprintf(full, sizeof(full), "%.*s/%s", (int)(slash-path), path, file);
+			else
+				snprintf(full, sizeof(full), "%s", file);
+			if(strcmp(file, "-") != 0 && gameLoadRoster(full) != 0){
+				game = builtIn;
+				free(paths);
+				fclose(f);
+				return n;
+			}
+			strcpy(paths[i], file);
+			s->rosters[s->rosterCount++] = game;
+			game = builtIn;
+		}
+		fx.roster = i;
+		if(s->count == capacity){
+			capacity = capacity ? 2*capacity : 64;
+			s->fixtures = realloc(s->fixtures, capacity*sizeof(struct fixture));
+		}
+		s->fixtures[s->count++] = fx;
+	}
+	fclose(f);
+	free(paths);
+	return 0;
+}
+
+//splits the fixtures into groups of the same roster and length, in the order of their first fixture. a group
+//has up to SEASON_GROUP fixtures, but fewer when a kind has too few fixtures to give every one of the workers
+//two groups, so the long fixtures still spread out. every rank works out the same groups
+void seasonGroup(struct season * s, int workers){
+	int * taken = calloc(s->count, sizeof(int));
+	int i, j, n = 0;
+	s->groupStart = malloc((s->count+1)*sizeof(int));
+	s->member = malloc(s->count*sizeof(int));
+	s->groupCount = 0;
+	for(i = 0; i < s->count; i++){
+		struct fixture * fx = &s->fixtures[i];
+		int kind = 0, size;
+		if(taken[i])
+			continue;
+		for(j = 0; j < s->count; j++)
+			kind += s->fixtures[j].roster == fx->roster && s->fixtures[j].rounds == fx->rounds;
+		size = kind/(2*workers);
+		if(size > SEASON_GROUP)
+			size = SEASON_GROUP;
+		if(size < 1)
+			size = 1;
+		s->groupStart[s->groupCount++] = n;
+		for(j = i; j < s->count && n - s->groupStart[s->groupCount-1] < size; j++){
+			if(!taken[j] && s->fixtures[j].roster == fx->roster && s->fixtures[j].rounds == fx->rounds){
+				taken[j] = 1;
+				s->member[n++] = j;
+			}
+		}
+	}
+	s->groupStart[s->groupCount] = n;
+	free(taken);
+}
+
+//group g on worker thread worker, in lockstep like batch. each fixture keeps its own seed and match id
+void seasonPlay(int g, int worker, void * arg){
+	struct season * s = arg;
+	int * member = s->member + s->groupStart[g];
+	int n = s->groupStart[g+1] - s->groupStart[g];
+	struct fixture * fx = &s->fixtures[member[0]];
+	unsigned int seeds[SEASON_GROUP];
+	int ids[SEASON_GROUP];
+	struct batch b;
+	int i, round, rounds;
+	game = s->rosters[fx->roster];
+	rounds = fx->rounds ? fx->rounds : ROUNDS;
+	batchInit(&b, n);
+	for(i = 0; i < n; i++){
+		seeds[i] = s->fixtures[member[i]].seed;
+		ids[i] = member[i];
+	}
+	b.seeds = seeds;
+	b.ids = ids;
+	for(round = 0; round < rounds; round++)
+		batchRound(&b, round);
+	for(i = 0; i < n; i++){
+		s->result[3*member[i]] = b.score[2*i];
+		s->result[3*member[i]+1] = b.score[2*i+1];
+		s->result[3*member[i]+2] = s->workerBase + worker;
+	}
+	batchFree(&b);
+}
@@ -0,0 +1,57 @@
+#include <stdlib.h>
+#include <string.h>
+#include "stats.h"
+
+static const char * statNames[STATS] = {"won", "shots", "made2", "made3", "passes", "reached", "distance"};
+
+void statsInit(struct matchStats * st, int enabled){
+	st->enabled = enabled;
+	memset(st->player, 0, sizeof(st->player));
+}
+
+//a player's info after its move
+void statsMove(struct matchStats * st, int id, int * playerInfo){
+	if(!st->enabled)
+		return;
+	st->player[id][STAT_REACHED] += playerInfo[REACH_RND];
+	st->player[id][STAT_DISTANCE] += abs(playerInfo[END_X] - playerInfo[INIT_X]) + abs(playerInfo[END_Y] - playerInfo[INIT_Y]);
+}
+
+//the ball owner's view of a resolved challenge: the winner's message says whether it shot or passed
+void statsChallenge(struct matchStats * st, int * playerMessage, int * ballChallengeInfo){
+	int winner = ballChallengeInfo[0];
+	if(!st->enabled || winner <= 0)
+		return;
+	long long * p = st->player[winner];
+	p[STAT_WON]++;
+	if(ballChallengeInfo[5] > 0 || playerMessage[winner*PLYR_MSG_SIZE+SHOT_TYPE] == SCORE){
+		p[STAT_SHOTS]++;
+		p[STAT_MADE2] += ballChallengeInfo[5] == 2;
+		p[STAT_MADE3] += ballChallengeInfo[5] == 3;
+	}
+	else
+		p[STAT_PASSES]++;
+}
+
+//collective over comm: sums every rank's counters on root, which prints one line per player
+void statsReport(struct matchStats * st, MPI_Comm comm, int root, FILE * out){
+	long long sum[MAX_PROCESSES][STATS];
+	int rank, i, f;
+	if(!st->enabled)
+		return;
+	MPI_Comm_rank(comm, &rank);
+	MPI_Reduce(st->player, sum, PROCESSES*STATS, MPI_LONG_LONG, MPI_SUM, root, comm);
+	if(rank != root)
+		return;
+	
+	fprintf(out, "player,team");
+	for(f = 0; f < STATS; f++)
+		fprintf(out, ",%s", statNames[f]);
+	fprintf(out, "\n");
+	for(i = 2; i < PROCESSES; i++){
+		fprintf(out, "%d,%c", i, 'a' + TEAM(i));
+		for(f = 0; f < STATS; f++)
+			fprintf(out, ",%lld", sum[i][f]);
+		fprintf(out, "\n");
+	}
+}
@@ -0,0 +1,29 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdio.h>
+#include <mpi.h>
+#include "game.h"
+
+//per-player match statistics (--stats). players count what their own info shows, the field process
+//that resolves a challenge counts the outcome, and the counters of all ranks are summed at the end
+#define STAT_WON 0		//possessions won
+#define STAT_SHOTS 1		//shot attempts, including every possession that scored
+#define STAT_MADE2 2
+#define STAT_MADE3 3
+#define STAT_PASSES 4
+#define STAT_REACHED 5		//rounds the player reached the ball
+#define STAT_DISTANCE 6		//squares run
+#define STATS 7
+
+struct matchStats{
+	int enabled;
+	long long player[MAX_PROCESSES][STATS];
+};
+
+void statsInit(struct matchStats *, int);
+void statsMove(struct matchStats *, int, int *);
+void statsChallenge(struct matchStats *, int *, int *);
+void statsReport(struct matchStats *, MPI_Comm, int, FILE *);
+
+#endif
@@ -0,0 +1,258 @@
+#include <stdlib.h>
+#include <time.h>
+#include "game.h"
+#include "steal.h"
+
+static long long threadNs(void){
+	struct timespec tp;
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &tp);
+	return (long long)tp.tv_nsec + (long long)tp.tv_sec * 1000000000ll;
+}
+
+static int queuePop(struct stealQueue * q, int * item){
+	int ok = 0;
+	pthread_mutex_lock(&q->lock);
+	if(q->tail > q->head){
+		*item = q->items[--q->tail];
+		ok = 1;
+	}
+	pthread_mutex_unlock(&q->lock);
+	return ok;
+}
+
+//q holds at most capacity items at a time, but the head moves on as thieves take from it
+static void queuePush(struct stealQueue * q, int * items, int n, int capacity){
+	int i;
+	pthread_mutex_lock(&q->lock);
+	if(q->tail + n > capacity){
+		for(i = q->head; i < q->tail; i++)
+			q->items[i - q->head] = q->items[i];
+		q->tail -= q->head;
+		q->head = 0;
+	}
+	for(i = 0; i < n; i++)
+		q->items[q->tail++] = items[i];
+	pthread_mutex_unlock(&q->lock);
+}
+
+//takes half of q, rounded up, from the head. returns how many
+static int queueTakeHalf(struct stealQueue * q, int * out){
+	int n, i;
+	pthread_mutex_lock(&q->lock);
+	n = (q->tail - q->head + 1)/2;
+	for(i = 0; i < n; i++)
+		out[i] = q->items[q->head++];
+	pthread_mutex_unlock(&q->lock);
+	return n;
+}
+
+static int queueSize(struct stealQueue * q){
+	int n;
+	pthread_mutex_lock(&q->lock);
+	n = q->tail - q->head;
+	pthread_mutex_unlock(&q->lock);
+	return n;
+}
+
+//whether worker w could find something to play without the main thread
+static int workAvailable(struct stealPool * p, int w){
+	int i;
+	if(!p->stealing)
+		return queueSize(&p->queues[w]) > 0;
+	for(i = 0; i < p->workers; i++){
+		if(queueSize(&p->queues[i]) > 0)
+			return 1;
+	}
+	return 0;
+}
+
+static int stealLocal(struct stealPool * p, struct stealWorker * w, int * buf){
+	int i;
+	if(!p->stealing)
+		return 0;
+	for(i = 1; i < p->workers; i++){
+		int n = queueTakeHalf(&p->queues[(w->index+i) % p->workers], buf);
+		if(n > 0){
+			queuePush(&p->queues[w->index], buf, n, p->total);
+			w->stolen += n;
+			return 1;
+		}
+	}
+	return 0;
+}
+
+static void * workerLoop(void * arg){
+	struct stealWorker * w = arg;
+	struct stealPool * p = w->pool;
+	int * buf = malloc((p->total > 0 ? p->total : 1)*sizeof(int));
+	int item;
+	for(;;){
+		if(queuePop(&p->queues[w->index], &item) || (stealLocal(p, w, buf) && queuePop(&p->queues[w->index], &item))){
+			long long before = threadNs();
+			p->play(item, w->index, p->arg);
+			w->busyNs += threadNs() - before;
+			w->played++;
+			continue;
+		}
+		pthread_mutex_lock(&p->lock);
+		while(!p->done && !workAvailable(p, w->index))
+			pthread_cond_wait(&p->wake, &p->lock);
+		int finished = p->done && !workAvailable(p, w->index);
+		pthread_mutex_unlock(&p->lock);
+		if(finished)
+			break;
+	}
+	free(buf);
+	return NULL;
+}
+
+//answers every steal request waiting, with half of the fullest queue. returns how many it answered
+static int serveSteals(struct stealPool * p, int * buf){
+	int flag, answered = 0;
+	MPI_Status status;
+	MPI_Iprobe(MPI_ANY_SOURCE, STEAL_TAG_ASK, p->comm, &flag, &status);
+	while(flag){
+		int i, fullest = 0, n = 0;
+		MPI_Recv(NULL, 0, MPI_INT, status.MPI_SOURCE, STEAL_TAG_ASK, p->comm, MPI_STATUS_IGNORE);
+		for(i = 1; i < p->workers; i++){
+			if(queueSize(&p->queues[i]) > queueSize(&p->queues[fullest]))
+				fullest = i;
+		}
+		if(p->stealing)
+			n = queueTakeHalf(&p->queues[fullest], buf);
+		MPI_Send(buf, n, MPI_INT, status.MPI_SOURCE, STEAL_TAG_GIVE, p->comm);
+		p->remoteOut += n;
+		answered++;
+		MPI_Iprobe(MPI_ANY_SOURCE, STEAL_TAG_ASK, p->comm, &flag, &status);
+	}
+	return answered;
+}
+
+//spreads items from another rank over the workers and wakes them
+static void deliver(struct stealPool * p, int * buf, int n){
+	int i;
+	for(i = 0; i < p->workers; i++){
+		int from = n*i/p->workers, to = n*(i+1)/p->workers;
+		queuePush(&p->queues[i], buf+from, to-from, p->total);
+	}
+	pthread_mutex_lock(&p->lock);
+	pthread_cond_broadcast(&p->wake);
+	pthread_mutex_unlock(&p->lock);
+}
+
+//plays items 0..total-1 with workers threads on every rank of comm, calling play(item, worker, arg) once per
+//item somewhere. the main thread schedules until every rank is out of items. collective over comm, which
+//needs mpi thread support of at least funneled. returns nonzero if a thread cannot be started
+int stealRun(struct stealPool * p, MPI_Comm comm, int workers, int total, int stealing, void (*play)(int, int, void *), void * arg){
+	int i;
+	p->comm = comm;
+	MPI_Comm_rank(comm, &p->rank);
+	MPI_Comm_size(comm, &p->size);
+	p->workers = workers;
+	p->total = total;
+	p->stealing = stealing;
+	p->play = play;
+	p->arg = arg;
+	p->done = 0;
+	p->remoteIn = p->remoteOut = 0;
+	pthread_mutex_init(&p->lock, NULL);
+	pthread_cond_init(&p->wake, NULL);
+	p->queues = malloc(workers*sizeof(struct stealQueue));
+	p->worker = calloc(workers, sizeof(struct stealWorker));
+
+	//blocks of the items by rank, then by worker. any queue may end up holding all of them
+	int first = (int)((long long)total*p->rank/p->size);
+	int count = (int)((long long)total*(p->rank+1)/p->size) - first;
+	for(i = 0; i < workers; i++){
+		struct stealQueue * q = &p->queues[i];
+		int from = count*i/workers, to = count*(i+1)/workers;
+		pthread_mutex_init(&q->lock, NULL);
+		q->items = malloc((total > 0 ? total : 1)*sizeof(int));
+		q->head = 0;
+		for(q->tail = 0; q->tail < to-from; q->tail++)
+			q->items[q->tail] = first + to - 1 - q->tail;		//reversed, so the owner plays its block in order
+	}
+	int * buf = malloc((total > 0 ? total : 1)*sizeof(int));
+
+	MPI_Barrier(comm);
+	long long before = wall_clock_time();
+	for(i = 0; i < workers; i++){
+		p->worker[i].pool = p;
+		p->worker[i].index = i;
+		if(pthread_create(&p->worker[i].thread, NULL, workerLoop, &p->worker[i]))
+			return 1;
+	}
+
+	int asking = 0, leaving = 0, misses = 0;
+	int victim = (p->rank+1) % p->size;
+	MPI_Request barrier;
+	for(;;){
+		int flag, active = serveSteals(p, buf);
+		if(!asking && !leaving){
+			int empty = 1;
+			for(i = 0; i < workers && empty; i++)
+				empty = queueSize(&p->queues[i]) == 0;
+			if(empty && (!stealing || misses >= p->size-1)){
+				MPI_Ibarrier(comm, &barrier);
+				leaving = 1;
+			}
+			else if(empty){
+				MPI_Send(NULL, 0, MPI_INT, victim, STEAL_TAG_ASK, comm);
+				asking = 1;
+			}
+		}
+		if(asking){
+			MPI_Status status;
+			MPI_Iprobe(victim, STEAL_TAG_GIVE, comm, &flag, &status);
+			if(flag){
+				int n;
+				MPI_Get_count(&status, MPI_INT, &n);
+				MPI_Recv(buf, n, MPI_INT, victim, STEAL_TAG_GIVE, comm, MPI_STATUS_IGNORE);
+				asking = 0;
+				active = 1;
+				if(n > 0){		//stay with a victim that had work
+					deliver(p, buf, n);
+					p->remoteIn += n;
+					misses = 0;
+				}
+				else{
+					misses++;
+					victim = (victim+1) % p->size;
+					if(victim == p->rank)
+						victim = (victim+1) % p->size;
+				}
+			}
+		}
+		if(leaving){
+			MPI_Test(&barrier, &flag, MPI_STATUS_IGNORE);
+			if(flag)
+				break;
+		}
+		if(!active){
+			struct timespec idle = {0, STEAL_IDLE_NS};
+			nanosleep(&idle, NULL);
+		}
+	}
+
+	pthread_mutex_lock(&p->lock);
+	p->done = 1;
+	pthread_cond_broadcast(&p->wake);
+	pthread_mutex_unlock(&p->lock);
+	for(i = 0; i < workers; i++)
+		pthread_join(p->worker[i].thread, NULL);
+	p->wallNs = wall_clock_time() - before;
+	free(buf);
+	return 0;
+}
+
+void stealFree(struct stealPool * p){
+	int i;
+	for(i = 0; i < p->workers; i++){
+		pthread_mutex_destroy(&p->queues[i].lock);
+		free(p->queues[i].items);
+	}
+	free(p->queues);
+	free(p->worker);
+	pthread_mutex_destroy(&p->lock);
+	pthread_cond_destroy(&p->wake);
+}
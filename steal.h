@@ -0,0 +1,55 @@
+#ifndef STEAL_H
+#define STEAL_H
+
+#include <pthread.h>
+#include <mpi.h>
+
+//work stealing over the ranks of a communicator and the worker threads of each rank. items 0..total-1 start
+//split in blocks over ranks and then workers. a worker plays its own queue from the tail, and once that is
+//empty takes half of a sibling's queue from the head. when every queue of a rank is empty its main thread,
+//which only schedules, asks the other ranks in turn for half of their fullest queue. a rank that has asked
+//them all in a row without getting anything enters a nonblocking barrier, and keeps answering with nothing
+//until every rank is in it
+#define STEAL_TAG_ASK 41
+#define STEAL_TAG_GIVE 42
+#define STEAL_IDLE_NS 50000		//main thread sleep when there is nothing to answer or collect
+
+struct stealQueue{
+	pthread_mutex_t lock;
+	int * items;
+	int head;		//thieves take from here
+	int tail;		//the owner pushes and pops here
+};
+
+struct stealWorker{
+	struct stealPool * pool;
+	int index;
+	pthread_t thread;
+	long long busyNs;		//cpu time inside play, so it is the work done even when workers share a core
+	int played;
+	int stolen;		//items taken from sibling workers
+};
+
+struct stealPool{
+	MPI_Comm comm;
+	int rank;
+	int size;
+	int workers;
+	int total;		//items over all ranks, and what a queue can hold
+	int stealing;		//0 plays the starting split only
+	void (*play)(int, int, void *);		//item, worker, arg
+	void * arg;
+	struct stealQueue * queues;
+	struct stealWorker * worker;
+	pthread_mutex_t lock;		//done, and waiting for work
+	pthread_cond_t wake;
+	int done;
+	int remoteIn;		//items this rank got from other ranks
+	int remoteOut;		//and gave away
+	long long wallNs;
+};
+
+int stealRun(struct stealPool *, MPI_Comm, int, int, int, void (*)(int, int, void *), void *);
+void stealFree(struct stealPool *);
+
+#endif
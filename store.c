@@ -0,0 +1,343 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "store.h"
+
+static int recordSize(int players){
+	return (sizeof(struct storeRecord) + players*PLYR_INFO_SIZE*sizeof(short) + 7) & ~7;		//keeps the index and directory 8 byte aligned
+}
+
+//one round of a text trace with players players. returns 0 at the end of the trace
+static int textNext(FILE * f, int players, struct traceRound * r){
+	int i, j, id;
+	if(fscanf(f, "%d %d %d %d %d", &r->round, &r->score[0], &r->score[1], &r->ballCoords[X], &r->ballCoords[Y]) != 5)
+		return 0;
+	for(i = 0; i < players; i++){
+		if(fscanf(f, "%d", &id) != 1)
+			return 0;
+		for(j = 0; j < PLYR_INFO_SIZE; j++){
+			if(fscanf(f, "%d", &r->playerInfo[i*PLYR_INFO_SIZE+j]) != 1)
+				return 0;
+		}
+	}
+	return 1;
+}
+
+//reads the trace at path, binary or text, writes its records to out at offset and appends its events to the
+//index, which holds *indexed of them. a text trace has no header, so it is read with the roster loaded.
+//returns 1 if the trace cannot be read or has no rounds, -1 if its records cannot be written
+static int storeIngest(FILE * out, long long offset, const char * path, struct storeMatch * m, struct storeEvent ** index, long long * indexed){
+	struct traceReader reader;
+	struct traceRound r;
+	FILE * text = NULL;
+	int binary = traceReadOpen(&reader, path) == 0;
+	int i, j, capacity = 0;
+	char * records = NULL;
+	if(binary){
+		m->seed = reader.seed;
+		m->players = reader.players;
+		m->teamSize = reader.teamSize;
+	}
+	else{
+		text = fopen(path, "r");
+		if(text == NULL)
+			return 1;
+		m->seed = 0;
+		m->players = PLAYERS;
+		m->teamSize = game.teamSize;
+	}
+	m->offset = offset;
+	m->recordSize = recordSize(m->players);
+	m->rounds = m->wins = m->scores = 0;
+	snprintf(m->name, STORE_NAME, "%s", path);
+
+	while(binary ? traceNext(&reader, &r) : textNext(text, m->players, &r)){
+		if(m->rounds == capacity){
+			capacity = capacity ? 2*capacity : 1024;
+			records = realloc(records, (size_t)capacity*m->recordSize);
+		}
+		struct storeRecord * rec = (struct storeRecord *)(records + (size_t)m->rounds++*m->recordSize);
+		memset(rec, 0, m->recordSize);
+		rec->round = r.round;
+		rec->score[0] = r.score[0];
+		rec->score[1] = r.score[1];
+		rec->ball[X] = (short)r.ballCoords[X];
+		rec->ball[Y] = (short)r.ballCoords[Y];
+		rec->winner = -1;
+		for(i = 0; i < m->players*PLYR_INFO_SIZE; i++)
+			rec->info[i] = (short)r.playerInfo[i];
+		for(i = 0; i < m->players && rec->winner < 0; i++){
+			if(r.playerInfo[i*PLYR_INFO_SIZE+WIN_RND] == 1)
+				rec->winner = i;
+		}
+		m->wins += rec->winner >= 0;
+	}
+	if(binary)
+		traceReadClose(&reader);
+	else
+		fclose(text);
+	if(m->rounds == 0){
+		free(records);
+		return 1;
+	}
+
+	//a round scored what the score moved by when the next one starts
+	*index = realloc(*index, (*indexed + 3*m->wins + 1)*sizeof(struct storeEvent));
+	m->events = *indexed;
+	struct storeEvent * byPlayer = *index + m->events;
+	struct storeEvent * wins = byPlayer + m->wins;
+	struct storeEvent * scores = wins + m->wins;
+	int next[MAX_PLAYERS];
+	memset(m->playerStart, 0, sizeof(m->playerStart));
+	for(i = 0, j = 0; i < m->rounds; i++){
+		struct storeRecord * rec = (struct storeRecord *)(records + (size_t)i*m->recordSize);
+		struct storeRecord * after = (struct storeRecord *)((char *)rec + m->recordSize);
+		if(i+1 < m->rounds)
+			rec->points = (short)(after->score[0] + after->score[1] - rec->score[0] - rec->score[1]);
+		if(rec->winner < 0)
+			continue;
+		wins[j].round = rec->round;
+		wins[j].player = rec->winner;
+		wins[j].points = rec->points;
+		if(rec->points > 0)
+			scores[m->scores++] = wins[j];
+		m->playerStart[rec->winner+1]++;
+		j++;
+	}
+	for(i = 0; i < m->players; i++){
+		m->playerStart[i+1] += m->playerStart[i];
+		next[i] = m->playerStart[i];
+	}
+	for(i = 0; i < m->wins; i++)
+		byPlayer[next[wins[i].player]++] = wins[i];
+	m->score[0] = ((struct storeRecord *)(records + (size_t)(m->rounds-1)*m->recordSize))->score[0];
+	m->score[1] = ((struct storeRecord *)(records + (size_t)(m->rounds-1)*m->recordSize))->score[1];
+
+	*indexed += 2*m->wins + m->scores;
+
+	int failed = fseeko(out, offset, SEEK_SET) != 0 || fwrite(records, m->recordSize, m->rounds, out) != (size_t)m->rounds;
+	free(records);
+	return failed ? -1 : 0;
+}
+
+//writes the store in f, with header h, again into path.tmp, the records of every match back to back and nothing
+//in between, then renames that over path. moves the directory's offsets along. returns nonzero if that fails,
+//in which case path is left as it was
+static int storeCompact(const char * path, FILE * f, struct storeHeader * h, struct storeMatch * directory, struct storeEvent * index, long long indexed){
+	char tmp[4096];
+	struct storeHeader next = *h;
+	long long offset = sizeof(next);
+	size_t chunk = 1 << 20;
+	char * buf = malloc(chunk);
+	int i, ok;
+	FILE * out;
+	snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+	out = fopen(tmp, "wb");
+	if(out == NULL){
+		free(buf);
+		return 1;
+	}
+	ok = buf != NULL && fwrite(&next, sizeof(next), 1, out) == 1;		//the real header goes in once the rest is
+	for(i = 0; i < h->matches && ok; i++){
+		struct storeMatch * m = &directory[i];
+		long long left = (long long)m->rounds*m->recordSize;
+		ok = fseeko(f, m->offset, SEEK_SET) == 0;
+		m->offset = offset;
+		offset += left;
+		while(ok && left > 0){
+			size_t n = left < (long long)chunk ? (size_t)left : chunk;
+			ok = fread(buf, 1, n, f) == n && fwrite(buf, 1, n, out) == n;
+			left -= n;
+		}
+	}
+	next.index = offset;
+	next.directory = offset + indexed*sizeof(struct storeEvent);
+	ok = ok && fwrite(index, sizeof(struct storeEvent), indexed, out) == (size_t)indexed
+		&& fwrite(directory, sizeof(struct storeMatch), h->matches, out) == (size_t)h->matches
+		&& fseeko(out, 0, SEEK_SET) == 0 && fwrite(&next, sizeof(next), 1, out) == 1;
+	free(buf);
+	if(fclose(out) != 0)
+		ok = 0;
+	if(ok && rename(tmp, path) == 0)
+		return 0;
+	remove(tmp);
+	return 1;
+}
+
+//adds the traces to the store at path, creating it if it is missing. returns 0, -1 if path is not a store, -2 if
+//it cannot be written, in which case it is left as it was, or i+1 if traces[i] cannot be read, in which case the
+//traces before it are kept
+int storeAdd(const char * path, char ** traces, int count){
+	struct storeHeader h = {STORE_MAGIC, STORE_VERSION, 0, 0, sizeof(struct storeHeader), sizeof(struct storeHeader)};
+	struct storeMatch * directory = NULL;
+	struct storeEvent * index = NULL;
+	long long indexed = 0;
+	int i, failed = 0, written;
+	FILE * f = fopen(path, "r+b");
+	if(f == NULL){
+		f = fopen(path, "w+b");
+		if(f == NULL)
+			return -2;
+		//an empty store first, so the file is one whatever happens to the rest
+		if(fwrite(&h, sizeof(h), 1, f) != 1 || fflush(f) != 0){
+			fclose(f);
+			return -2;
+		}
+	}
+	else{
+		if(fread(&h, sizeof(h), 1, f) != 1 || h.magic != STORE_MAGIC || h.version != STORE_VERSION || h.matches < 0
+			|| h.index > h.directory){
+			fclose(f);
+			return -1;
+		}
+		//the old index and directory are written again after the new records
+		indexed = (h.directory - h.index)/sizeof(struct storeEvent);
+		index = malloc((indexed+1)*sizeof(struct storeEvent));
+		directory = malloc((h.matches+1)*sizeof(struct storeMatch));
+		if(fseeko(f, h.index, SEEK_SET) != 0 || fread(index, sizeof(struct storeEvent), indexed, f) != (size_t)indexed
+			|| fread(directory, sizeof(struct storeMatch), h.matches, f) != (size_t)h.matches){
+			free(index);
+			free(directory);
+			fclose(f);
+			return -1;
+		}
+	}
+
+	//everything new goes after the old directory, so until the header is rewritten it still points at an index
+	//and directory that are whole. the old ones are left behind as unused space, until storeCompact drops it
+	struct storeHeader next = h;
+	long long offset = h.directory + (long long)h.matches*sizeof(struct storeMatch);
+	written = 1;
+	directory = realloc(directory, (h.matches+count+1)*sizeof(struct storeMatch));
+	for(i = 0; i < count; i++){
+		struct storeMatch * m = &directory[next.matches];
+		int ingested = storeIngest(f, offset, traces[i], m, &index, &indexed);
+		if(ingested < 0)
+			written = 0;
+		if(ingested != 0){
+			failed = i+1;
+			break;
+		}
+		offset += (long long)m->rounds*m->recordSize;
+		next.matches++;
+	}
+	next.index = offset;
+	next.directory = offset + indexed*sizeof(struct storeEvent);
+	written = written && fseeko(f, offset, SEEK_SET) == 0
+		&& fwrite(index, sizeof(struct storeEvent), indexed, f) == (size_t)indexed
+		&& fwrite(directory, sizeof(struct storeMatch), next.matches, f) == (size_t)next.matches && fflush(f) == 0;
+	if(written)		//only once the rest is in the file
+		written = fseeko(f, 0, SEEK_SET) == 0 && fwrite(&next, sizeof(next), 1, f) == 1 && fflush(f) == 0;
+	if(written){
+		//once the space left behind is more than the store holds, it is copied without it. every add leaves an
+		//index and directory behind, so the copies cost about as much as writing those did. the store is whole
+		//already, so if the copy fails it is just kept as it is
+		long long live = sizeof(next) + indexed*sizeof(struct storeEvent) + (long long)next.matches*sizeof(struct storeMatch);
+		for(i = 0; i < next.matches; i++)
+			live += (long long)directory[i].rounds*directory[i].recordSize;
+		if(next.directory + next.matches*(long long)sizeof(struct storeMatch) - live > live)
+			storeCompact(path, f, &next, directory, index, indexed);
+	}
+	free(index);
+	free(directory);
+	if(fclose(f) != 0 || !written)
+		return -2;
+	return failed;
+}
+
+//maps the store at path. returns nonzero if it is missing or not a store
+int storeOpen(struct store * s, const char * path){
+	struct stat st;
+	struct storeHeader * h;
+	int i;
+	s->fd = open(path, O_RDONLY);
+	if(s->fd < 0)
+		return 1;
+	if(fstat(s->fd, &st) != 0 || st.st_size < (off_t)sizeof(struct storeHeader)){
+		close(s->fd);
+		return 1;
+	}
+	s->size = st.st_size;
+	s->base = mmap(NULL, s->size, PROT_READ, MAP_SHARED, s->fd, 0);
+	if(s->base == MAP_FAILED){
+		close(s->fd);
+		return 1;
+	}
+	h = (struct storeHeader *)s->base;
+	if(h->magic != STORE_MAGIC || h->version != STORE_VERSION || h->matches < 0 || h->index < (long long)sizeof(*h)
+		|| h->index > h->directory || (size_t)h->directory + (size_t)h->matches*sizeof(struct storeMatch) > s->size){
+		storeClose(s);
+		return 1;
+	}
+	s->matches = h->matches;
+	s->index = (struct storeEvent *)(s->base + h->index);
+	s->directory = (struct storeMatch *)(s->base + h->directory);
+	for(i = 0; i < s->matches; i++){
+		struct storeMatch * m = &s->directory[i];
+		if(m->players < 2 || m->players > MAX_PLAYERS || m->offset < (long long)sizeof(*h)
+			|| m->offset + (long long)m->rounds*m->recordSize > h->index
+			|| (m->events + 2*m->wins + m->scores)*(long long)sizeof(struct storeEvent) > h->directory - h->index){
+			storeClose(s);
+			return 1;
+		}
+	}
+	return 0;
+}
+
+void storeClose(struct store * s){
+	munmap(s->base, s->size);
+	close(s->fd);
+}
+
+//record i of match m
+struct storeRecord * storeRecordAt(struct store * s, int m, int i){
+	struct storeMatch * d = &s->directory[m];
+	return (struct storeRecord *)(s->base + d->offset + (size_t)i*d->recordSize);
+}
+
+//the wins of player p of match m, n of them, in round order
+struct storeEvent * storeWinsByPlayer(struct store * s, int m, int p, int * n){
+	struct storeMatch * d = &s->directory[m];
+	*n = d->playerStart[p+1] - d->playerStart[p];
+	return s->index + d->events + d->playerStart[p];
+}
+
+//every win of match m in round order, directory[m].wins of them
+struct storeEvent * storeWins(struct store * s, int m){
+	return s->index + s->directory[m].events + s->directory[m].wins;
+}
+
+//the wins of match m that scored, directory[m].scores of them
+struct storeEvent * storeScores(struct store * s, int m){
+	return s->index + s->directory[m].events + 2*s->directory[m].wins;
+}
+
+//the first of n events in round order that is at round or later, n if none is
+int storeFirstFrom(struct storeEvent * events, int n, int round){
+	int lo = 0, hi = n;
+	while(lo < hi){
+		int mid = (lo+hi)/2;
+		if(events[mid].round < round)
+			lo = mid+1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+//a record of match m back as a round of its trace
+void storeRoundOf(struct store * s, int m, struct storeRecord * rec, struct traceRound * r){
+	int i;
+	r->round = rec->round;
+	r->score[0] = rec->score[0];
+	r->score[1] = rec->score[1];
+	r->ballCoords[X] = rec->ball[X];
+	r->ballCoords[Y] = rec->ball[Y];
+	for(i = 0; i < s->directory[m].players*PLYR_INFO_SIZE; i++)
+		r->playerInfo[i] = rec->info[i];
+}
@@ -0,0 +1,80 @@
+#ifndef STORE_H
+#define STORE_H
+
+#include "trace.h"
+
+//replay store: many match traces in one file, read through mmap so a query only touches the pages it needs.
+//the file is a header, the rounds of every match as fixed size records, the index, then a directory with one
+//entry per match. the index holds the events of the matches one after the other, so a query over all of them
+//reads one small contiguous area: the rounds each player won the ball in, player by player, then every win
+//and every scoring round, in round order. adding matches writes their records after the old directory, then
+//the whole index and directory after them, and the header last, so a failed add leaves the old store whole.
+//once the old copies left behind outgrow the store, add writes it again without them and renames it over
+//a record is the round's trace (score and ball when it starts, player info when it ends) plus what fp0's ball
+//challenge info said: who won the ball and the points it scored. the trace keeps score only at the start of a
+//round, so the points of the last round are not known and count as 0
+#define STORE_MAGIC 0x54534242		//"BBST"
+#define STORE_VERSION 1
+#define STORE_NAME 64
+
+struct storeHeader{
+	int magic;
+	int version;
+	int matches;
+	int pad;
+	long long index;		//offset of the index
+	long long directory;		//and of the directory
+};
+
+struct storeRecord{
+	int round;
+	int score[2];
+	short ball[2];
+	short winner;		//player that won the ball, -1 if nobody did
+	short points;		//scored by the winner's team
+	short info[];		//PLYR_INFO_SIZE shorts for each player
+};
+
+//a win of the ball. player is an index into the match's players, team b's after team a's
+struct storeEvent{
+	int round;
+	short player;
+	short points;
+};
+
+struct storeMatch{
+	long long offset;		//of the first record
+	long long events;		//where its events start in the index
+	unsigned int seed;		//0 for a text trace
+	int players;
+	int teamSize;
+	int rounds;
+	int recordSize;
+	int score[2];		//when the last round starts
+	int wins;
+	int scores;
+	int playerStart[MAX_PLAYERS+1];		//where each player's wins start among the wins by player
+	char name[STORE_NAME];		//the trace it came from
+};
+
+//a store opened for queries
+struct store{
+	int fd;
+	size_t size;
+	char * base;
+	int matches;
+	struct storeEvent * index;
+	struct storeMatch * directory;
+};
+
+int storeAdd(const char *, char **, int);
+int storeOpen(struct store *, const char *);
+void storeClose(struct store *);
+struct storeRecord * storeRecordAt(struct store *, int, int);
+struct storeEvent * storeWinsByPlayer(struct store *, int, int, int *);
+struct storeEvent * storeWins(struct store *, int);
+struct storeEvent * storeScores(struct store *, int);
+int storeFirstFrom(struct storeEvent *, int, int);
+void storeRoundOf(struct store *, int, struct storeRecord *, struct traceRound *);
+
+#endif
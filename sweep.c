@@ -0,0 +1,302 @@
+#include <stdio.h>
+#include <time.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <mpi.h>
+#include "game.h"
+#include "lockstep.h"
+
+//strategy and skill sweep for team a against the roster's team b, with successive halving: every configuration
+//plays a few matches, the better 1/eta of them play eta times as many, and so on until --top are left.
+//configuration 0 is the roster as loaded. the other ones keep each player's skill total and redraw how it is
+//split, the shot threshold and the near radius
+struct sweepConfig{
+	int speed[MAX_PLAYERS];
+	int dribbling[MAX_PLAYERS];
+	int shooting[MAX_PLAYERS];
+	int shot;
+	int near;
+};
+
+//per configuration totals, summed over ranks. doubles so one allreduce covers them
+#define SWEEP_PLAYED 0
+#define SWEEP_MARGIN 1		//team a's points minus team b's
+#define SWEEP_SQUARES 2
+#define SWEEP_WINS 3
+#define SWEEP_STATS 4
+
+struct sweepOptions{
+	int configs;
+	int matches;	//per configuration in the first rung
+	int eta;
+	int top;
+	int rounds;
+	unsigned int seed;
+	char * rosterPath;
+	char * outPath;
+};
+
+static struct gameConfig base;
+
+int parseSweepOptions(int, char **, struct sweepOptions *);
+void sweepDraw(struct sweepConfig *, unsigned int, int);
+void sweepApply(struct sweepConfig *);
+void sweepPlay(struct sweepConfig *, int, int, int, unsigned int, double *);
+int sweepCompare(const void *, const void *);
+void sweepReport(FILE *, struct sweepConfig *, double *, int *, int *, int);
+
+static double * sortStats;
+
+int main(int argc, char *argv[]){
+	struct sweepOptions opts;
+	int rank, size, c, i, j, r;
+	MPI_Init(&argc, &argv);
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+	if(parseSweepOptions(argc, argv, &opts)){
+		if(rank == 0)
+			printf("usage: sweep [--configs n] [--matches n] [--eta n] [--top n] [--rounds n] [--seed n] [--roster file] [--out file]\n");
+		MPI_Finalize();
+		return 1;
+	}
+	int line = rank == 0 && opts.rosterPath != NULL ? gameLoadRoster(opts.rosterPath) : 0;
+	MPI_Bcast(&line, 1, MPI_INT, 0, MPI_COMM_WORLD);
+	if(line){
+		if(rank == 0)
+			printf("cannot load roster %s (line %d)\n", opts.rosterPath, line);
+		MPI_Finalize();
+		return 1;
+	}
+	MPI_Bcast(&game, sizeof(game), MPI_BYTE, 0, MPI_COMM_WORLD);
+	MPI_Bcast(&opts.seed, 1, MPI_UNSIGNED, 0, MPI_COMM_WORLD);
+	if(opts.rounds == 0)
+		opts.rounds = ROUNDS;
+	base = game;
+
+	struct sweepConfig * configs = malloc(opts.configs*sizeof(struct sweepConfig));
+	double * stats = calloc(opts.configs*SWEEP_STATS, sizeof(double));
+	double * delta = malloc(opts.configs*SWEEP_STATS*sizeof(double));
+	int * alive = malloc(opts.configs*sizeof(int));		//configurations still in, best first after each rung
+	int * rung = calloc(opts.configs, sizeof(int));		//last rung a configuration played in
+	for(c = 0; c < opts.configs; c++){
+		sweepDraw(&configs[c], opts.seed, c);
+		alive[c] = c;
+	}
+
+	int count = opts.configs;
+	int target = opts.matches;
+	int k = 0;
+	long long played = 0;
+	long long before = wall_clock_time();
+	while(1){
+		//every configuration still in has played the same matches and plays up to target. the rung's matches,
+		//configuration by configuration, are cut into one contiguous share per rank, so late rungs with fewer
+		//configurations than ranks still keep every rank busy
+		int done = (int)stats[alive[0]*SWEEP_STATS+SWEEP_PLAYED];
+		long long work = (long long)count*(target-done);
+		long long from = work*rank/size, to = work*(rank+1)/size;
+		memset(delta, 0, opts.configs*SWEEP_STATS*sizeof(double));
+		while(from < to){
+			int first = done + (int)(from%(target-done));
+			int last = to - from < target - first ? first + (int)(to-from) : target;
+			c = alive[from/(target-done)];
+			sweepPlay(&configs[c], first, last, opts.rounds, opts.seed, delta+c*SWEEP_STATS);
+			from += last - first;
+		}
+		MPI_Allreduce(MPI_IN_PLACE, delta, opts.configs*SWEEP_STATS, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+		for(i = 0; i < count; i++){
+			c = alive[i];
+			played += (long long)delta[c*SWEEP_STATS+SWEEP_PLAYED];
+			for(j = 0; j < SWEEP_STATS; j++)
+				stats[c*SWEEP_STATS+j] += delta[c*SWEEP_STATS+j];
+			rung[c] = k;
+		}
+		sortStats = stats;
+		qsort(alive, count, sizeof(int), sweepCompare);
+		if(rank == 0)
+			fprintf(stderr, "rung %d: %d configurations x %d matches\n", k, count, target);
+
+		int keep = (count + opts.eta - 1)/opts.eta;
+		if(count <= opts.top)
+			break;
+		count = keep > opts.top ? keep : opts.top;
+		target *= opts.eta;
+		k++;
+	}
+	double sec = (double)(wall_clock_time()-before)/1000000000;
+
+	if(rank == 0){
+		//survivors in rank order, then the rest by the rung they reached and their mean margin there
+		int * order = malloc(opts.configs*sizeof(int));
+		int n = 0;
+		for(i = 0; i < count; i++)
+			order[n++] = alive[i];
+		for(r = k-1; r >= 0; r--){
+			int from = n;
+			for(c = 0; c < opts.configs; c++){
+				if(rung[c] == r)
+					order[n++] = c;
+			}
+			qsort(order+from, n-from, sizeof(int), sweepCompare);
+		}
+		FILE * out = opts.outPath != NULL ? fopen(opts.outPath, "w") : stdout;
+		if(out == NULL)
+			fprintf(stderr, "cannot open %s\n", opts.outPath);
+		else{
+			sweepReport(out, configs, stats, rung, order, opts.configs);
+			if(out != stdout)
+				fclose(out);
+		}
+		fprintf(stderr, "%d configurations, %d rungs, %lld matches x %d rounds in %1.5f sec on %d ranks, %1.1f matches/sec\n",
+			opts.configs, k+1, played, opts.rounds, sec, size, played/sec);
+		free(order);
+	}
+
+	free(configs);
+	free(stats);
+	free(delta);
+	free(alive);
+	free(rung);
+	MPI_Finalize();
+	return 0;
+}
+
+//returns nonzero if the command line is not understood
+int parseSweepOptions(int argc, char *argv[], struct sweepOptions * opts){
+	int i;
+	opts->configs = 1024;
+	opts->matches = 32;
+	opts->eta = 2;
+	opts->top = 10;
+	opts->rounds = 0;		//the roster's
+	opts->seed = (unsigned int)time(NULL);
+	opts->rosterPath = NULL;
+	opts->outPath = NULL;
+	for(i = 1; i < argc; i++){
+		if(strcmp(argv[i], "--configs") == 0 && i+1 < argc){
+			opts->configs = atoi(argv[++i]);
+			if(opts->configs <= 0)
+				return 1;
+		}
+		else if(strcmp(argv[i], "--matches") == 0 && i+1 < argc){
+			opts->matches = atoi(argv[++i]);
+			if(opts->matches <= 0)
+				return 1;
+		}
+		else if(strcmp(argv[i], "--eta") == 0 && i+1 < argc){
+			opts->eta = atoi(argv[++i]);
+			if(opts->eta < 2)
+				return 1;
+		}
+		else if(strcmp(argv[i], "--top") == 0 && i+1 < argc){
+			opts->top = atoi(argv[++i]);
+			if(opts->top <= 0)
+				return 1;
+		}
+		else if(strcmp(argv[i], "--rounds") == 0 && i+1 < argc){
+			opts->rounds = atoi(argv[++i]);
+			if(opts->rounds <= 0)
+				return 1;
+		}
+		else if(strcmp(argv[i], "--seed") == 0 && i+1 < argc)
+			opts->seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+		else if(strcmp(argv[i], "--roster") == 0 && i+1 < argc)
+			opts->rosterPath = argv[++i];
+		else if(strcmp(argv[i], "--out") == 0 && i+1 < argc)
+			opts->outPath = argv[++i];
+		else
+			return 1;
+	}
+	return 0;
+}
+
+//configuration c, drawn from stream (seed, c) at round -1, which no match plays, so every rank draws the same
+void sweepDraw(struct sweepConfig * config, unsigned int seed, int c){
+	struct rngStream rng;
+	int p;
+	rngStart(&rng, seed, c, -1, 0);
+	for(p = 0; p < base.teamSize; p++){
+		struct rosterPlayer * r = &base.roster[p];
+		int total = r->speed + r->dribbling + r->shooting;
+		config->speed[p] = r->speed;
+		config->dribbling[p] = r->dribbling;
+		config->shooting[p] = r->shooting;
+		if(c == 0)
+			continue;
+		config->speed[p] = rngNext(&rng) % total + 1;
+		config->dribbling[p] = rngNext(&rng) % (total - config->speed[p] + 1);
+		config->shooting[p] = total - config->speed[p] - config->dribbling[p];
+	}
+	config->shot = c == 0 ? base.shot[0] : rngNext(&rng) % 76 + 20;		//20..95 percent
+	config->near = c == 0 ? base.near[0] : rngNext(&rng) % 11;
+}
+
+//the roster with team a playing configuration config
+void sweepApply(struct sweepConfig * config){
+	int p;
+	game = base;
+	for(p = 0; p < game.teamSize; p++){
+		game.roster[p].speed = config->speed[p];
+		game.roster[p].dribbling = config->dribbling[p];
+		game.roster[p].shooting = config->shooting[p];
+	}
+	game.shot[0] = config->shot;
+	game.near[0] = config->near;
+}
+
+//plays matches first..target-1 of configuration config in lockstep and adds them to stats. match ids are shared
+//by all configurations, so they are compared on the same draws
+void sweepPlay(struct sweepConfig * config, int first, int target, int rounds, unsigned int seed, double * stats){
+	struct batch b;
+	int round, m;
+	if(target <= first)
+		return;
+	sweepApply(config);
+	batchInit(&b, target-first);
+	b.seed = seed;
+	b.first = first;
+	for(round = 0; round < rounds; round++)
+		batchRound(&b, round);
+	for(m = 0; m < b.n; m++){
+		int margin = b.score[m*2] - b.score[m*2+1];
+		stats[SWEEP_PLAYED] += 1;
+		stats[SWEEP_MARGIN] += margin;
+		stats[SWEEP_SQUARES] += (double)margin*margin;
+		stats[SWEEP_WINS] += margin > 0;
+	}
+	batchFree(&b);
+	game = base;
+}
+
+//best mean margin first, ties to the lower configuration
+int sweepCompare(const void * a, const void * b){
+	int ca = *(const int *)a, cb = *(const int *)b;
+	double * sa = sortStats+ca*SWEEP_STATS;
+	double * sb = sortStats+cb*SWEEP_STATS;
+	double ma = sa[SWEEP_MARGIN]/sa[SWEEP_PLAYED];
+	double mb = sb[SWEEP_MARGIN]/sb[SWEEP_PLAYED];
+	if(ma != mb)
+		return ma > mb ? -1 : 1;
+	return ca - cb;
+}
+
+//csv, one line per configuration in the given order. margin is the mean of a's points minus b's, with its
+//standard error. players are team a's speed/dribbling/shooting in roster order
+void sweepReport(FILE * out, struct sweepConfig * configs, double * stats, int * rung, int * order, int n){
+	int i, p;
+	fprintf(out, "place,config,rung,matches,margin,stderr,win_rate,shot,near,players\n");
+	for(i = 0; i < n; i++){
+		int c = order[i];
+		double * s = stats+c*SWEEP_STATS;
+		double played = s[SWEEP_PLAYED];
+		double mean = s[SWEEP_MARGIN]/played;
+		double var = played > 1 ? (s[SWEEP_SQUARES] - played*mean*mean)/(played-1) : 0;
+		fprintf(out, "%d,%d,%d,%1.0f,%1.3f,%1.3f,%1.3f,%d,%d,", i+1, c, rung[c], played, mean,
+			sqrt(var > 0 ? var/played : 0), s[SWEEP_WINS]/played, configs[c].shot, configs[c].near);
+		for(p = 0; p < base.teamSize; p++)
+			fprintf(out, "%s%d/%d/%d", p ? " " : "", configs[c].speed[p], configs[c].dribbling[p], configs[c].shooting[p]);
+		fprintf(out, "\n");
+	}
+}
@@ -0,0 +1,115 @@
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "telemetry.h"
+
+//the shared memory object of name: posix names start with a slash
+static void shmName(char * out, const char * name){
+	snprintf(out, TELEM_NAME, "/%s", name);
+}
+
+//creates the ring for match. returns nonzero if the shared memory cannot be set up
+int telemetryOpen(struct telemetry * t, const char * name, int match, unsigned int seed, int rounds){
+	int fd;
+	shmName(t->name, name);
+	fd = shm_open(t->name, O_CREAT | O_RDWR | O_TRUNC, 0644);
+	if(fd < 0)
+		return 1;
+	if(ftruncate(fd, sizeof(struct telemetryRing)) != 0){
+		close(fd);
+		shm_unlink(t->name);
+		return 1;
+	}
+	t->ring = mmap(NULL, sizeof(struct telemetryRing), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if(t->ring == MAP_FAILED){
+		shm_unlink(t->name);
+		return 1;
+	}
+	t->ring->slots = TELEM_SLOTS;
+	t->ring->match = match;
+	t->ring->seed = seed;
+	t->ring->rounds = rounds;
+	t->ring->version = TELEM_VERSION;
+	atomic_store_explicit(&t->ring->head, 0, memory_order_relaxed);
+	atomic_store_explicit(&t->ring->done, 0, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+	t->ring->magic = TELEM_MAGIC;		//last, so a reader never sees a half made ring as valid
+	t->next = 0;
+	t->last = t->windowStart = wall_clock_time();
+	t->roundsPerSec = 0;
+	t->publishNs = 0;
+	return 0;
+}
+
+//called by fp0 at the end of every round, with the time it spent in mpi waits during it
+void telemetryPublish(struct telemetry * t, int round, int * score, int * ball, long long waitNs){
+	long long now = wall_clock_time();
+	unsigned long n = t->next++;
+	struct telemetrySlot * slot = &t->ring->slot[n % TELEM_SLOTS];
+	if(n % TELEM_WINDOW == TELEM_WINDOW-1){
+		t->roundsPerSec = TELEM_WINDOW*1e9/(now - t->windowStart);
+		t->windowStart = now;
+	}
+	atomic_store_explicit(&slot->seq, 0, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+	slot->sample.round = round;
+	slot->sample.score[0] = score[0];
+	slot->sample.score[1] = score[1];
+	slot->sample.ball[X] = ball[X];
+	slot->sample.ball[Y] = ball[Y];
+	slot->sample.roundsPerSec = t->roundsPerSec;
+	slot->sample.roundNs = now - t->last;
+	slot->sample.waitNs = waitNs;
+	atomic_store_explicit(&slot->seq, n+1, memory_order_release);
+	atomic_store_explicit(&t->ring->head, n+1, memory_order_release);
+	t->last = now;
+	t->publishNs += wall_clock_time() - now;
+}
+
+//marks the match over and removes the name. a reader still attached keeps the ring until it detaches
+void telemetryClose(struct telemetry * t){
+	atomic_store_explicit(&t->ring->done, 1, memory_order_release);
+	munmap(t->ring, sizeof(struct telemetryRing));
+	shm_unlink(t->name);
+}
+
+void telemetryReport(struct telemetry * t, FILE * out){
+	fprintf(out, "telemetry: %lu samples, %1.1f nsec/sample to publish\n", t->next, t->next ? (double)t->publishNs/t->next : 0.0);
+}
+
+//maps the ring of name for reading, NULL if there is none yet
+struct telemetryRing * telemetryAttach(const char * name){
+	char path[TELEM_NAME];
+	struct telemetryRing * ring;
+	shmName(path, name);
+	int fd = shm_open(path, O_RDONLY, 0);
+	if(fd < 0)
+		return NULL;
+	ring = mmap(NULL, sizeof(struct telemetryRing), PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if(ring == MAP_FAILED)
+		return NULL;
+	atomic_thread_fence(memory_order_acquire);
+	if(ring->magic != TELEM_MAGIC || ring->version != TELEM_VERSION || ring->slots != TELEM_SLOTS){
+		munmap(ring, sizeof(struct telemetryRing));
+		return NULL;
+	}
+	return ring;
+}
+
+//copies sample n. returns 0 if it is not published yet, or was overwritten before or while it was copied
+int telemetryRead(struct telemetryRing * ring, unsigned long n, struct telemetrySample * out){
+	struct telemetrySlot * slot = &ring->slot[n % TELEM_SLOTS];
+	if(atomic_load_explicit(&slot->seq, memory_order_acquire) != n+1)
+		return 0;
+	memcpy(out, &slot->sample, sizeof(*out));
+	atomic_thread_fence(memory_order_acquire);
+	return atomic_load_explicit(&slot->seq, memory_order_relaxed) == n+1;
+}
+
+void telemetryDetach(struct telemetryRing * ring){
+	munmap(ring, sizeof(struct telemetryRing));
+}
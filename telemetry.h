@@ -0,0 +1,65 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdio.h>
+#include <stdatomic.h>
+#include "game.h"
+
+//--telemetry: fp0 publishes a sample per round into a ring in posix shared memory, for telemetry_watch to
+//follow the match live. publishing is a few stores and never waits for a reader: sample n goes to slot
+//n % TELEM_SLOTS whether or not it was read, so a reader that falls behind loses samples. a slot's seq is
+//n+1 once sample n is in it and 0 while it is being written, so a reader copies a slot and keeps the copy
+//only if seq was n+1 before and after
+#define TELEM_MAGIC 0x4c544242		//"BBTL"
+#define TELEM_VERSION 1
+#define TELEM_SLOTS 1024
+#define TELEM_WINDOW 64		//rounds the throughput is measured over
+#define TELEM_NAME 256
+
+struct telemetrySample{
+	int round;
+	int score[2];
+	int ball[2];
+	int pad;
+	double roundsPerSec;		//over the last TELEM_WINDOW rounds
+	long long roundNs;
+	long long waitNs;		//fp0's mpi waits in the round
+};
+
+struct telemetrySlot{
+	atomic_ulong seq;
+	struct telemetrySample sample;
+};
+
+struct telemetryRing{
+	int magic;
+	int version;
+	int slots;
+	int match;
+	unsigned int seed;
+	int rounds;		//the match is played to
+	_Alignas(CACHE_LINE) atomic_ulong head;		//samples published
+	atomic_int done;
+	_Alignas(CACHE_LINE) struct telemetrySlot slot[TELEM_SLOTS];
+};
+
+//fp0's side
+struct telemetry{
+	struct telemetryRing * ring;
+	char name[TELEM_NAME];
+	unsigned long next;
+	long long last;		//when the previous round ended
+	long long windowStart;
+	double roundsPerSec;
+	long long publishNs;		//spent publishing, for --timing
+};
+
+int telemetryOpen(struct telemetry *, const char *, int, unsigned int, int);
+void telemetryPublish(struct telemetry *, int, int *, int *, long long);
+void telemetryClose(struct telemetry *);
+void telemetryReport(struct telemetry *, FILE *);
+struct telemetryRing * telemetryAttach(const char *);
+int telemetryRead(struct telemetryRing *, unsigned long, struct telemetrySample *);
+void telemetryDetach(struct telemetryRing *);
+
+#endif
@@ -0,0 +1,96 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "telemetry.h"
+
+//follows the telemetry of a match started with --telemetry name. waits for the match to start, then prints
+//the newest sample every interval, or with --all every sample it gets to before it is overwritten, until the
+//match is over. a match that ended or died before it was attached, or stops publishing without ending, is given
+//up on after --timeout seconds without a new sample
+static void printSample(struct telemetrySample * s){
+	printf("round %d score %d %d ball %d %d %1.0f rounds/sec round %1.1f usec wait %1.1f usec\n", s->round, s->score[0],
+		s->score[1], s->ball[X], s->ball[Y], s->roundsPerSec, (double)s->roundNs/1000, (double)s->waitNs/1000);
+	fflush(stdout);
+}
+
+int main(int argc, char *argv[]){
+	struct telemetryRing * ring;
+	struct telemetrySample sample;
+	unsigned long next = 0, read = 0, dropped = 0;
+	int i, all = 0, intervalMs = 500, timeout = 10, stale = 0, bad = 0;
+	const char * name = NULL;
+	for(i = 1; i < argc; i++){
+		if(strcmp(argv[i], "--interval") == 0 && i+1 < argc)
+			intervalMs = atoi(argv[++i]);
+		else if(strcmp(argv[i], "--all") == 0)
+			all = 1;
+		else if(strcmp(argv[i], "--timeout") == 0 && i+1 < argc)
+			timeout = atoi(argv[++i]);
+		else if(name == NULL && argv[i][0] != '-')
+			name = argv[i];
+		else
+			bad = 1;
+	}
+	if(bad || name == NULL || intervalMs <= 0 || timeout < 0){
+		printf("usage: telemetry_watch name [--interval ms] [--all] [--timeout sec]\n");
+		return 1;
+	}
+	struct timespec interval = {intervalMs/1000, (long)(intervalMs%1000)*1000000};
+	if(all){		//poll often enough to keep up with a fast match
+		interval.tv_sec = 0;
+		interval.tv_nsec = 1000000;
+	}
+
+	long long limit = (long long)timeout*1000000000;		//0 waits for ever
+	long long alive = wall_clock_time();		//when the match last showed it is running
+	unsigned long seen = 0;
+	while((ring = telemetryAttach(name)) == NULL){
+		if(limit && wall_clock_time() - alive > limit){
+			fprintf(stderr, "no match %s after %d sec\n", name, timeout);
+			return 1;
+		}
+		nanosleep(&interval, NULL);
+	}
+	fprintf(stderr, "match %d, seed %u, %d rounds\n", ring->match, ring->seed, ring->rounds);
+	alive = wall_clock_time();
+	for(;;){
+		int done = atomic_load_explicit(&ring->done, memory_order_acquire);
+		unsigned long head = atomic_load_explicit(&ring->head, memory_order_acquire);
+		if(all){
+			for(; next < head; next++){
+				if(telemetryRead(ring, next, &sample)){
+					printSample(&sample);
+					read++;
+				}
+				else
+					dropped++;
+			}
+		}
+		else if(head > next){		//only the newest, the rest count as skipped
+			for(i = 0; i < 3 && !telemetryRead(ring, head-1, &sample); i++)
+				;
+			if(i < 3){
+				printSample(&sample);
+				read++;
+			}
+			dropped += head - next - (i < 3);
+			next = head;
+		}
+		if(done && next == atomic_load_explicit(&ring->head, memory_order_acquire))
+			break;
+		if(head != seen){
+			seen = head;
+			alive = wall_clock_time();
+		}
+		else if(limit && wall_clock_time() - alive > limit){
+			fprintf(stderr, "no sample for %d sec, the match is gone\n", timeout);
+			stale = 1;
+			break;
+		}
+		nanosleep(&interval, NULL);
+	}
+	fprintf(stderr, "%lu samples, %lu read, %lu %s\n", next, read, dropped, all ? "dropped" : "skipped");
+	telemetryDetach(ring);
+	return stale;
+}
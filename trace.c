@@ -0,0 +1,147 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "trace.h"
+
+#define TRACE_STDIO_BUF (1 << 22)
+
+//the text trace, one round at a time
+void tracePrintRound(FILE * out, struct traceRound * r){
+	int i;
+	int * currPlayer = r->playerInfo;
+	fprintf(out, "%d\n%d %d\n%d %d\n", r->round, r->score[0], r->score[1], r->ballCoords[X], r->ballCoords[Y]);
+	for(i = 0; i < PLAYERS; i++){
+		fprintf(out, "%d %d %d %d %d %d %d %d %d %d\n", i < game.teamSize ? i : i-game.teamSize, *(currPlayer+INIT_X), *(currPlayer+INIT_Y), *(currPlayer+END_X),
+			*(currPlayer+END_Y), *(currPlayer+REACH_RND), *(currPlayer+WIN_RND), *(currPlayer+CHALLENGE), *(currPlayer+SHOOT_X), *(currPlayer+SHOOT_Y));
+		currPlayer += PLYR_INFO_SIZE;
+	}
+}
+
+//returns nonzero if the file cannot be created or its buffers cannot be allocated
+int traceOpen(struct traceWriter * w, const char * path, unsigned int seed){
+	int header[6] = {TRACE_MAGIC, TRACE_VERSION, PLAYERS, TRACE_BLOCK, (int)seed, game.teamSize};
+	w->cols = malloc(TRACE_COLS(PLAYERS)*TRACE_BLOCK*sizeof(int));
+	w->narrow = malloc(TRACE_BLOCK*sizeof(short));
+	w->file = w->cols != NULL && w->narrow != NULL ? fopen(path, "wb") : NULL;
+	if(w->file == NULL){
+		free(w->cols);
+		free(w->narrow);
+		return 1;
+	}
+	setvbuf(w->file, NULL, _IOFBF, TRACE_STDIO_BUF);
+	w->failed = fwrite(header, sizeof(int), 6, w->file) != 6;
+	w->rounds = 0;
+	return 0;
+}
+
+//returns nonzero if the block could not be written
+static int traceFlush(struct traceWriter * w){
+	int c, i;
+	if(w->rounds == 0)
+		return 0;
+	if(fwrite(&w->rounds, sizeof(int), 1, w->file) != 1)
+		w->failed = 1;
+	for(c = 0; c < TRACE_WIDE_COLS; c++){
+		if(fwrite(w->cols+c*TRACE_BLOCK, sizeof(int), w->rounds, w->file) != (size_t)w->rounds)
+			w->failed = 1;
+	}
+	for(; c < TRACE_COLS(PLAYERS); c++){
+		int * col = w->cols+c*TRACE_BLOCK;
+		for(i = 0; i < w->rounds; i++)
+			w->narrow[i] = (short)col[i];
+		if(fwrite(w->narrow, sizeof(short), w->rounds, w->file) != (size_t)w->rounds)
+			w->failed = 1;
+	}
+	w->rounds = 0;
+	return w->failed;
+}
+
+//a few stores per round, the file only sees whole blocks. a failed write shows up in traceClose
+void traceAppend(struct traceWriter * w, struct traceRound * r){
+	int * col = w->cols + w->rounds;
+	int i;
+	col[0*TRACE_BLOCK] = r->round;
+	col[1*TRACE_BLOCK] = r->score[0];
+	col[2*TRACE_BLOCK] = r->score[1];
+	col[3*TRACE_BLOCK] = r->ballCoords[X];
+	col[4*TRACE_BLOCK] = r->ballCoords[Y];
+	col += TRACE_HEADER_COLS*TRACE_BLOCK;
+	for(i = 0; i < PLAYERS*PLYR_INFO_SIZE; i++)
+		col[i*TRACE_BLOCK] = r->playerInfo[i];
+	if(++w->rounds == TRACE_BLOCK)
+		traceFlush(w);
+}
+
+//returns nonzero if any of the trace could not be written
+int traceClose(struct traceWriter * w){
+	int failed = traceFlush(w) || ferror(w->file);
+	if(fclose(w->file) != 0)
+		failed = 1;
+	free(w->cols);
+	free(w->narrow);
+	return failed;
+}
+
+//returns nonzero if the file is missing or not a trace, or the buffers cannot be allocated. the trace may come
+//from another roster, see players and teamSize
+int traceReadOpen(struct traceReader * r, const char * path){
+	int header[6];
+	r->file = fopen(path, "rb");
+	if(r->file == NULL)
+		return 1;
+	if(fread(header, sizeof(int), 6, r->file) != 6 || header[0] != TRACE_MAGIC || header[1] != TRACE_VERSION
+		|| header[2] < 2 || header[2] > MAX_PLAYERS || header[3] != TRACE_BLOCK || header[5] < 1 || header[5] >= header[2]){
+		fclose(r->file);
+		return 1;
+	}
+	setvbuf(r->file, NULL, _IOFBF, TRACE_STDIO_BUF);
+	r->seed = (unsigned int)header[4];
+	r->players = header[2];
+	r->teamSize = header[5];
+	r->rounds = r->next = 0;
+	r->cols = malloc(TRACE_COLS(r->players)*TRACE_BLOCK*sizeof(int));
+	r->narrow = malloc(TRACE_BLOCK*sizeof(short));
+	if(r->cols == NULL || r->narrow == NULL){
+		free(r->cols);
+		free(r->narrow);
+		fclose(r->file);
+		return 1;
+	}
+	return 0;
+}
+
+//returns 0 at the end of the trace
+int traceNext(struct traceReader * r, struct traceRound * out){
+	int c, i;
+	if(r->next == r->rounds){
+		if(fread(&r->rounds, sizeof(int), 1, r->file) != 1 || r->rounds <= 0 || r->rounds > TRACE_BLOCK)
+			return 0;
+		for(c = 0; c < TRACE_WIDE_COLS; c++){
+			if(fread(r->cols+c*TRACE_BLOCK, sizeof(int), r->rounds, r->file) != (size_t)r->rounds)
+				return 0;
+		}
+		for(; c < TRACE_COLS(r->players); c++){
+			int * col = r->cols+c*TRACE_BLOCK;
+			if(fread(r->narrow, sizeof(short), r->rounds, r->file) != (size_t)r->rounds)
+				return 0;
+			for(i = 0; i < r->rounds; i++)
+				col[i] = r->narrow[i];
+		}
+		r->next = 0;
+	}
+	int * col = r->cols + r->next++;
+	out->round = col[0*TRACE_BLOCK];
+	out->score[0] = col[1*TRACE_BLOCK];
+	out->score[1] = col[2*TRACE_BLOCK];
+	out->ballCoords[X] = col[3*TRACE_BLOCK];
+	out->ballCoords[Y] = col[4*TRACE_BLOCK];
+	col += TRACE_HEADER_COLS*TRACE_BLOCK;
+	for(i = 0; i < r->players*PLYR_INFO_SIZE; i++)
+		out->playerInfo[i] = col[i*TRACE_BLOCK];
+	return 1;
+}
+
+void traceReadClose(struct traceReader * r){
+	fclose(r->file);
+	free(r->cols);
+	free(r->narrow);
+}
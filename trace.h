@@ -0,0 +1,60 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdio.h>
+#include "game.h"
+
+//binary trace: a header (with the seed the match was played with and the size of both teams), then blocks of
+//up to TRACE_BLOCK rounds.
+//a block is its round count k followed by TRACE_COLS columns of k values each:
+//round and score of both teams as ints, then ball coordinates and the PLYR_INFO_SIZE
+//fields of every player as shorts (court coordinates and challenge scores fit easily)
+#define TRACE_MAGIC 0x52544242		//"BBTR"
+#define TRACE_VERSION 3
+#define TRACE_BLOCK 1024
+#define TRACE_HEADER_COLS 5
+#define TRACE_WIDE_COLS 3
+#define TRACE_COLS(players) (TRACE_HEADER_COLS + (players)*PLYR_INFO_SIZE)
+
+//what fp0 does with each round
+#define OUTPUT_TEXT 0
+#define OUTPUT_BINARY 1
+#define OUTPUT_NONE 2		//play the rounds, keep nothing
+#define OUTPUT_SCORE 3		//not even the player info: only the final score
+
+//what fp0 knows about a round: score and ball when it starts, player info when it ends
+struct traceRound{
+	int round;
+	int score[2];
+	int ballCoords[2];
+	int playerInfo[MAX_PLAYERS*PLYR_INFO_SIZE];		//the first PLAYERS are used
+};
+
+struct traceWriter{
+	FILE * file;
+	int rounds;		//rounds buffered in cols
+	int * cols;
+	short * narrow;		//one short column on its way to the file
+	int failed;		//a write came up short
+};
+
+struct traceReader{
+	FILE * file;
+	unsigned int seed;
+	int players;		//roster the trace was played with
+	int teamSize;
+	int rounds;		//rounds in the current block
+	int next;
+	int * cols;
+	short * narrow;
+};
+
+void tracePrintRound(FILE *, struct traceRound *);
+int traceOpen(struct traceWriter *, const char *, unsigned int);
+void traceAppend(struct traceWriter *, struct traceRound *);
+int traceClose(struct traceWriter *);
+int traceReadOpen(struct traceReader *, const char *);
+int traceNext(struct traceReader *, struct traceRound *);
+void traceReadClose(struct traceReader *);
+
+#endif
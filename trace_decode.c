@@ -0,0 +1,22 @@
+#include <stdio.h>
+#include "trace.h"
+
+//prints a binary trace written by match --output binary in the text format
+int main(int argc, char *argv[]){
+	struct traceReader reader;
+	struct traceRound r;
+	if(argc != 2){
+		printf("usage: trace_decode file\n");
+		return 1;
+	}
+	if(traceReadOpen(&reader, argv[1])){
+		fprintf(stderr, "%s: not a match trace\n", argv[1]);
+		return 1;
+	}
+	game.players = reader.players;		//print with the trace's own team split
+	game.teamSize = reader.teamSize;
+	while(traceNext(&reader, &r))
+		tracePrintRound(stdout, &r);
+	traceReadClose(&reader);
+	return 0;
+}
@@ -0,0 +1,102 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <sched.h>
+#include "writer.h"
+
+//sleeping and head are stored and loaded seq_cst on both sides: either fp0 sees the writer asleep and wakes it,
+//or the writer sees the rounds fp0 added before it waits
+
+static void * writerLoop(void * arg){
+	struct roundWriter * w = arg;
+	game = *w->config;
+	unsigned long tail = atomic_load_explicit(&w->tail, memory_order_relaxed);
+	for(;;){
+		unsigned long head = atomic_load_explicit(&w->head, memory_order_acquire);
+		if(tail == head){
+			if(atomic_load_explicit(&w->done, memory_order_acquire) && tail == atomic_load_explicit(&w->head, memory_order_acquire))
+				break;
+			pthread_mutex_lock(&w->lock);
+			atomic_store(&w->sleeping, 1);
+			while(atomic_load(&w->head) - tail < WRITER_BATCH && !atomic_load(&w->done))
+				pthread_cond_wait(&w->wake, &w->lock);
+			atomic_store(&w->sleeping, 0);
+			pthread_mutex_unlock(&w->lock);
+			continue;
+		}
+		for(; tail != head; tail++){
+			struct traceRound * r = &w->slots[tail % WRITER_SLOTS];
+			if(w->output == OUTPUT_BINARY)
+				traceAppend(w->trace, r);
+			else if(w->output == OUTPUT_TEXT)
+				tracePrintRound(stdout, r);
+			atomic_store_explicit(&w->tail, tail+1, memory_order_release);
+		}
+	}
+	return NULL;
+}
+
+static void writerWake(struct roundWriter * w){
+	pthread_mutex_lock(&w->lock);
+	pthread_cond_signal(&w->wake);
+	pthread_mutex_unlock(&w->lock);
+}
+
+//returns nonzero if the ring cannot be allocated or the thread cannot be started
+int writerStart(struct roundWriter * w, int output, struct traceWriter * trace){
+	atomic_init(&w->head, 0);
+	atomic_init(&w->tail, 0);
+	atomic_init(&w->done, 0);
+	atomic_init(&w->sleeping, 0);
+	w->slots = malloc(WRITER_SLOTS*sizeof(struct traceRound));
+	if(w->slots == NULL)
+		return 1;
+	w->output = output;
+	w->trace = trace;
+	w->config = &game;
+	w->fullWaits = w->waitNs = 0;
+	w->maxDepth = 0;
+	pthread_mutex_init(&w->lock, NULL);
+	pthread_cond_init(&w->wake, NULL);
+	if(pthread_create(&w->thread, NULL, writerLoop, w) != 0){
+		pthread_mutex_destroy(&w->lock);
+		pthread_cond_destroy(&w->wake);
+		free(w->slots);
+		return 1;
+	}
+	return 0;
+}
+
+void writerPush(struct roundWriter * w, struct traceRound * r){
+	unsigned long head = atomic_load_explicit(&w->head, memory_order_relaxed);
+	unsigned long tail = atomic_load_explicit(&w->tail, memory_order_acquire);
+	if(head - tail == WRITER_SLOTS){
+		long long before = wall_clock_time();
+		w->fullWaits++;
+		while(head - tail == WRITER_SLOTS){
+			sched_yield();
+			tail = atomic_load_explicit(&w->tail, memory_order_acquire);
+		}
+		w->waitNs += wall_clock_time() - before;
+	}
+	w->slots[head % WRITER_SLOTS] = *r;
+	atomic_store(&w->head, head+1);
+	if(head+1 - tail > w->maxDepth)
+		w->maxDepth = head+1 - tail;
+	if(atomic_load(&w->sleeping) && head+1 - atomic_load_explicit(&w->tail, memory_order_acquire) >= WRITER_BATCH)
+		writerWake(w);
+}
+
+//drains whatever is left and joins the thread
+void writerStop(struct roundWriter * w){
+	atomic_store(&w->done, 1);
+	writerWake(w);
+	pthread_join(w->thread, NULL);
+	pthread_mutex_destroy(&w->lock);
+	pthread_cond_destroy(&w->wake);
+	free(w->slots);
+}
+
+void writerReport(struct roundWriter * w, FILE * out){
+	fprintf(out, "writer: %lu rounds, ring full %lld times, fp0 waited %1.5f sec, max depth %lu/%d\n",
+		atomic_load(&w->head), w->fullWaits, (double)w->waitNs/1000000000, w->maxDepth, WRITER_SLOTS);
+}
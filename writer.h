@@ -0,0 +1,37 @@
+#ifndef WRITER_H
+#define WRITER_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include "trace.h"
+
+//fp0 hands finished rounds to a helper thread through a single producer single consumer ring,
+//so printing or trace writing never holds up the next round. a writer that has drained the ring sleeps on a
+//condition variable, and fp0 only wakes it once WRITER_BATCH rounds are waiting, or at the end
+#define WRITER_SLOTS 4096
+#define WRITER_BATCH 64
+
+struct roundWriter{
+	_Alignas(CACHE_LINE) atomic_ulong head;		//next slot fp0 fills
+	_Alignas(CACHE_LINE) atomic_ulong tail;		//next slot the writer drains
+	_Alignas(CACHE_LINE) atomic_int done;
+	atomic_int sleeping;		//the writer is waiting on wake, or about to
+	pthread_mutex_t lock;
+	pthread_cond_t wake;
+	struct traceRound * slots;
+	int output;
+	struct traceWriter * trace;
+	const struct gameConfig * config;		//fp0's game, for the player count and team sizes
+	pthread_t thread;
+	//backpressure, only touched by fp0
+	long long fullWaits;		//pushes that found the ring full
+	long long waitNs;		//time fp0 spent waiting for a free slot
+	unsigned long maxDepth;
+};
+
+int writerStart(struct roundWriter *, int, struct traceWriter *);
+void writerPush(struct roundWriter *, struct traceRound *);
+void writerStop(struct roundWriter *);
+void writerReport(struct roundWriter *, FILE *);
+
+#endif